@@ -12,55 +12,100 @@
 /*========================================================================================
 	Dependencies
 ========================================================================================*/
+#include <algorithm>
 #include <chrono>
-#include <ctime>
 #include <iostream>
 #include <random>
+#include <string>
 #include <CL/cl.h>
+#include "CommandLine.h"
+#include "PerfCounters.h"
 #include "Pixel.h"
+#include "Roofline.h"
+#include "RunConfig.h"
+
+/*========================================================================================
+	Constants
+========================================================================================*/
+/** The halving reads and writes one float4 per pixel and does one multiply per channel. */
+const double HALVE_BYTES_PER_PIXEL = 2 * sizeof(cl_float4);
+const double HALVE_FLOPS_PER_PIXEL = 4;
 
 
 /*========================================================================================
 	Fields
 ========================================================================================*/
-const int NUM_PIXELS = 1000000;
+RunConfig _config;
+PerfCounters _perfCounters;
+Roofline _hostRoofline;
 std::vector<cl_float4> _startPixels;
 std::vector<cl_float4> _resultPixels;
-int _startTime;
-int _endTime;
-int _timeToRun;
 
 /*========================================================================================
 	Main Function
 ========================================================================================*/
 /**
 	Creates a collection of "pixels" (represented by cl_float4s indicating RGBA values) and 
-	halves them to represent reducing the screen brightness.
+	halves them to represent reducing the screen brightness. The pixel count, number of 
+	runs and seed come from --pixels, --iterations and --seed, or a --config file. 
+	--perf-counters prints the hardware counters of each run where the kernel allows it, 
+	and --measure-peaks compares each run with the host's STREAM triad bandwidth.
 */
-int main()
+int main(int argc, char* argv[])
 {
+	/* Read the problem size. */
+	std::string configError;
+	if (!_config.Load(argc, argv, configError))
+	{
+		std::cout << "ERROR: " << configError << "\n\n";
+		std::cin.ignore();
+		return 1;
+	}
+	_config.Print(std::cout);
+
+	if (CommandLine::HasFlag(argc, argv, "--perf-counters", "PIXELCL_PERF_COUNTERS") && !_perfCounters.Open())
+	{
+		std::cout << "Running without hardware counters: " << _perfCounters.GetError() << ".\n\n";
+	}
+
+	if (CommandLine::HasFlag(argc, argv, "--measure-peaks", "PIXELCL_MEASURE_PEAKS"))
+	{
+		_hostRoofline = Roofline::MeasureHost();
+		std::cout << "Measured host triad bandwidth of " << _hostRoofline.GetPeakGBs() << " GB/s.\n\n";
+	}
+
 	/* Initialize fields. */
 	_startPixels = std::vector<cl_float4>();
 	_resultPixels = std::vector<cl_float4>();
 
-	/* Seed the random number generator. */
-	srand((unsigned int) time(nullptr));
-
-	/* Generate pixels. */
-	std::cout << "Generating pixels...\n\n";
-	for (int i = 0; i < NUM_PIXELS; i++)
+	/* Generate pixels from the seed, so a run can be repeated with --seed. */
+	std::cout << "Generating pixels with seed " << _config.seed << "...\n\n";
+	for (size_t i = 0; i < _config.numPixels; i++)
 	{
-		_startPixels.push_back(Pixel::MakeRandomPixel());
+		_startPixels.push_back(Pixel::MakeRandomPixel(_config.seed, i));
 	}
 
 	/* Calculate the average color, timing how long it takes to calculate this. */
-	std::cout << "Reducing brightness. Timer starts now!\n\n";
-	_startTime = clock();
-	Pixel::HalveBrightness(_startPixels, _resultPixels);
-	_endTime = clock();
-	_timeToRun = (_endTime - _startTime) / (double) CLOCKS_PER_SEC * 1000;
+	int bestTime = 0;
+	for (int iteration = 1; iteration <= _config.iterations; iteration++)
+	{
+		std::cout << "Reducing brightness. Timer starts now!\n\n";
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		PerfRegion perfRegion(_perfCounters, "HalveBrightness", std::cout);
+		Pixel::HalveBrightness(_startPixels, _resultPixels);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		int timeToRun = (int)(seconds * 1000);
 
-	std::cout << "Done. Time to calculate: " << _timeToRun << " ms\n\n";
+		std::cout << "Done. Time to calculate: " << timeToRun << " ms\n\n";
+		perfRegion.End();
+		_hostRoofline.Report(std::cout, HALVE_BYTES_PER_PIXEL * _config.numPixels, HALVE_FLOPS_PER_PIXEL * _config.numPixels, seconds);
+		bestTime = (iteration == 1) ? timeToRun : std::min(bestTime, timeToRun);
+	}
+
+	if (_config.iterations > 1)
+	{
+		std::cout << "Best of " << _config.iterations << " runs: " << bestTime << " ms\n\n";
+	}
 
 	/* Print out results.*/
 	std::cout << "Sample initial pixel: \n" << 
@@ -0,0 +1,175 @@
+/*===================================================================================*//**
+	PixelBench
+	
+	Micro-benchmarks of the Pixel primitives and their faster replacements, at working 
+	sets that fit in each cache level and in DRAM.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <CL/cl.h>
+#include "CommandLine.h"
+#include "HostTopology.h"
+#include "MicroBenchmark.h"
+#include "PerfCounters.h"
+#include "Pixel.h"
+
+/*========================================================================================
+	Constants
+========================================================================================*/
+/** Number of working set sizes: one per cache level, then DRAM. */
+const int NUM_LEVELS = 4;
+
+/** Names of the working set sizes. */
+const char* LEVEL_NAMES[NUM_LEVELS] = { "L1", "L2", "L3", "DRAM" };
+
+/** Cache sizes assumed when the host does not report them. */
+const size_t DEFAULT_CACHE_SIZES[NUM_LEVELS - 1] = { 32 * 1024, 1024 * 1024, 32 * 1024 * 1024 };
+
+/** The smallest and largest working sets used for DRAM. The cap keeps the original 
+generator, which calls rand() four times a pixel, to a few seconds per run. */
+const size_t MIN_DRAM_BYTES = 64 * 1024 * 1024;
+const size_t MAX_DRAM_BYTES = 256 * 1024 * 1024;
+
+/*========================================================================================
+	Main Function
+========================================================================================*/
+/**
+	Times each Pixel primitive against its faster replacement at four working set 
+	sizes: half of L1, L2 and L3, and twice L3 (between 64 and 256 MB). Options are --repetitions (10 by 
+	default), --min-time in seconds per repetition (0.05 by default), --filter to run 
+	only benchmarks whose names contain it, --baseline to compare with a saved run and 
+	--save-baseline to save this one. --perf-counters counts one more iteration of each 
+	benchmark with the hardware counters, where the kernel allows it.
+*/
+int main(int argc, char* argv[])
+{
+	std::string repetitions = CommandLine::GetOption(argc, argv, "--repetitions", "PIXELBENCH_REPETITIONS");
+	std::string minTime = CommandLine::GetOption(argc, argv, "--min-time", "PIXELBENCH_MIN_TIME");
+	std::string filter = CommandLine::GetOption(argc, argv, "--filter", "PIXELBENCH_FILTER");
+	std::string baselinePath = CommandLine::GetOption(argc, argv, "--baseline", "PIXELBENCH_BASELINE");
+	std::string saveBaselinePath = CommandLine::GetOption(argc, argv, "--save-baseline", "PIXELBENCH_SAVE_BASELINE");
+
+	MicroBenchmark bench(
+		repetitions.empty() ? 10 : std::atoi(repetitions.c_str()), 
+		minTime.empty() ? 0.05 : std::atof(minTime.c_str()), 
+		filter);
+
+	if (!baselinePath.empty() && !bench.LoadBaseline(baselinePath))
+	{
+		std::cout << "ERROR: Could not read baseline " << baselinePath << ".\n\n";
+		return 1;
+	}
+
+	PerfCounters perfCounters;
+	if (CommandLine::HasFlag(argc, argv, "--perf-counters", "PIXELCL_PERF_COUNTERS") && !perfCounters.Open())
+	{
+		std::cout << "Running without hardware counters: " << perfCounters.GetError() << ".\n\n";
+	}
+
+	/* Size the working sets from the host's caches. */
+	size_t levelBytes[NUM_LEVELS];
+	for (int level = 0; level < NUM_LEVELS - 1; level++)
+	{
+		size_t cacheSize = HostTopology::GetCacheSize(level + 1);
+		levelBytes[level] = (cacheSize > 0 ? cacheSize : DEFAULT_CACHE_SIZES[level]) / 2;
+	}
+	levelBytes[NUM_LEVELS - 1] = std::clamp(levelBytes[NUM_LEVELS - 2] * 4, MIN_DRAM_BYTES, MAX_DRAM_BYTES);
+
+	std::cout << "Working sets:";
+	for (int level = 0; level < NUM_LEVELS; level++)
+	{
+		std::cout << " " << LEVEL_NAMES[level] << " " << (levelBytes[level] >> 10) << " KB";
+	}
+	std::cout << "\n\n";
+	MicroBenchmark::PrintHeader(std::cout);
+
+	auto runAndPrint = [&bench, &perfCounters](const std::string& name, size_t bytes, const std::function<void()>& body)
+	{
+		if (bench.Run(name, bytes, body))
+		{
+			bench.Print(std::cout, bench.GetResults().back());
+
+			/* Count one more iteration, so the counts are per call rather than per run. */
+			PerfRegion perfRegion(perfCounters, name.c_str(), std::cout);
+			body();
+		}
+	};
+
+	for (int level = 0; level < NUM_LEVELS; level++)
+	{
+		std::string suffix = std::string("/") + LEVEL_NAMES[level];
+
+		/* Generating and averaging touch one buffer, halving touches two. */
+		size_t onePixels = std::max<size_t>(levelBytes[level] / sizeof(cl_float4), 4);
+		size_t twoPixels = std::max<size_t>(onePixels / 2, 4);
+
+		std::vector<cl_float4> pixels(onePixels);
+		std::vector<cl_float4> results(twoPixels);
+		for (size_t i = 0; i < pixels.size(); i++)
+		{
+			pixels[i] = Pixel::MakeRandomPixel(1, i);
+		}
+		std::vector<cl_float4> halfPixels(pixels.begin(), pixels.begin() + twoPixels);
+		uint32_t seed = 1;
+
+		runAndPrint("MakeRandomPixel/original" + suffix, onePixels * sizeof(cl_float4), [&]()
+		{
+			for (cl_float4& eachPixel : pixels)
+			{
+				eachPixel = Pixel::MakeRandomPixel();
+			}
+		});
+		runAndPrint("MakeRandomPixel/fast" + suffix, onePixels * sizeof(cl_float4), [&]()
+		{
+			for (size_t i = 0; i < pixels.size(); i++)
+			{
+				pixels[i] = Pixel::MakeRandomPixel(seed, i);
+			}
+			seed++;
+		});
+
+		runAndPrint("HalveBrightness/original" + suffix, twoPixels * 2 * sizeof(cl_float4), [&]()
+		{
+			Pixel::HalveBrightness(halfPixels, results);
+		});
+		runAndPrint("HalveBrightness/fast" + suffix, twoPixels * 2 * sizeof(cl_float4), [&]()
+		{
+			Pixel::HalveBrightness(halfPixels.data(), results.data(), halfPixels.size());
+		});
+
+		runAndPrint("GetAverageColor/original" + suffix, onePixels * sizeof(cl_float4), [&]()
+		{
+			MicroBenchmark::KeepAlive(Pixel::GetAverageColor(pixels).x);
+		});
+		runAndPrint("GetAverageColor/fast" + suffix, onePixels * sizeof(cl_float4), [&]()
+		{
+			MicroBenchmark::KeepAlive(Pixel::GetAverageColor(pixels.data(), pixels.size()).x);
+		});
+	}
+	std::cout << "\n";
+
+	if (!saveBaselinePath.empty())
+	{
+		if (!bench.SaveBaseline(saveBaselinePath))
+		{
+			std::cout << "ERROR: Could not write baseline " << saveBaselinePath << ".\n\n";
+			return 1;
+		}
+
+		std::cout << "Saved baseline to " << saveBaselinePath << ".\n\n";
+	}
+
+	return 0;
+}
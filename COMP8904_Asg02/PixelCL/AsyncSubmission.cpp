@@ -0,0 +1,232 @@
+/*===================================================================================*//**
+	AsyncSubmission
+	
+	Non-blocking submission of write, kernel and read batches, completed through 
+	cl_event callbacks instead of clFinish.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see AsyncSubmission
+	@see AsyncSubmission.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "AsyncSubmission.h"
+#include <chrono>
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	State kept alive from submission until the read-back event completes.
+*/
+struct AsyncBatchState
+{
+	public:
+		std::promise<cl_int> promise;
+		CompletionCallback onComplete;
+		cl_event events[3];
+};
+
+/*----------------------------------------------------------------------------------------
+	AsyncHandle Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates an empty handle that refers to no batch.
+*/
+AsyncHandle::AsyncHandle()
+{
+}
+
+/**
+	Creates a handle for the batch whose status will be delivered through the future.
+*/
+AsyncHandle::AsyncHandle(std::shared_future<cl_int> future) : _future(future)
+{
+}
+
+/**
+	Returns whether the handle refers to a batch.
+*/
+bool AsyncHandle::IsValid() const
+{
+	return _future.valid();
+}
+
+/**
+	Returns whether the batch has finished, without blocking.
+*/
+bool AsyncHandle::IsReady() const
+{
+	return _future.valid() && 
+		_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+/**
+	Blocks until the batch has finished and returns its status.
+*/
+cl_int AsyncHandle::Wait() const
+{
+	if (!_future.valid())
+	{
+		return CL_INVALID_VALUE;
+	}
+
+	return _future.get();
+}
+
+/**
+	Returns the future that receives the batch's status.
+*/
+std::shared_future<cl_int> AsyncHandle::GetFuture() const
+{
+	return _future;
+}
+
+/*----------------------------------------------------------------------------------------
+	AsyncSubmission Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Enqueues a write, a kernel launch and a read for the pixels 
+	[firstPixel, firstPixel + numPixels) and returns straight away.
+	
+	The three commands are chained through their events, so they stay ordered even on 
+	an out-of-order queue. The kernel gets the input and output buffers as arguments 0 
+	and 1 and is launched over exactly numPixels work-items with a matching global 
+	offset. If localSize does not divide numPixels, the runtime picks the work-group 
+	size. The host arrays must stay alive until the handle is ready. onComplete, if 
+	given, is called with the same status the handle reports.
+*/
+AsyncHandle AsyncSubmission::Submit(
+	cl_command_queue commandQueue, cl_kernel kernel, 
+	cl_mem input, cl_mem output, 
+	const cl_float4* hostInput, cl_float4* hostOutput, 
+	size_t firstPixel, size_t numPixels, size_t localSize, 
+	CompletionCallback onComplete)
+{
+	cl_int result = 0;
+	AsyncBatchState* state = new AsyncBatchState();
+	state->onComplete = onComplete;
+	state->events[0] = state->events[1] = state->events[2] = nullptr;
+	AsyncHandle handle(state->promise.get_future().share());
+
+	size_t offset = sizeof(cl_float4) * firstPixel;
+	size_t size = sizeof(cl_float4) * numPixels;
+	size_t globalOffset = firstPixel;
+	size_t globalSize = numPixels;
+	const size_t* localSizePtr = (localSize != 0 && numPixels % localSize == 0) ? &localSize : NULL;
+
+	result = clEnqueueWriteBuffer(
+		commandQueue, input,
+		CL_FALSE, offset,
+		size, hostInput + firstPixel,
+		0, NULL,
+		&state->events[0]
+	);
+
+	if (result == CL_SUCCESS)
+	{
+		result = clSetKernelArg(kernel, 0, sizeof(cl_mem), &input);
+		result |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &output);
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		result = clEnqueueNDRangeKernel(
+			commandQueue, kernel,
+			1, &globalOffset,
+			&globalSize, localSizePtr,
+			1, &state->events[0],
+			&state->events[1]
+		);
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		result = clEnqueueReadBuffer(
+			commandQueue, output,
+			CL_FALSE, offset,
+			size, hostOutput + firstPixel,
+			1, &state->events[1],
+			&state->events[2]
+		);
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		result = clSetEventCallback(state->events[2], CL_COMPLETE, OnReadComplete, state);
+	}
+
+	if (result != CL_SUCCESS)
+	{
+		/* Anything already enqueued still references the host arrays, so let it drain. */
+		for (cl_event eachEvent : state->events)
+		{
+			if (eachEvent)
+			{
+				clWaitForEvents(1, &eachEvent);
+			}
+		}
+
+		OnReadComplete(nullptr, result, state);
+		return handle;
+	}
+
+	/* Make sure the batch starts without waiting for a later blocking call. */
+	clFlush(commandQueue);
+
+	return handle;
+}
+
+/**
+	Waits for every handle and returns the first error reported, or CL_SUCCESS.
+*/
+cl_int AsyncSubmission::WaitAll(const AsyncHandle* handles, size_t numHandles)
+{
+	cl_int firstError = CL_SUCCESS;
+
+	for (size_t i = 0; i < numHandles; i++)
+	{
+		cl_int status = handles[i].Wait();
+
+		if (status != CL_SUCCESS && firstError == CL_SUCCESS)
+		{
+			firstError = status;
+		}
+	}
+
+	return firstError;
+}
+
+/**
+	Completes a batch once its read-back has finished or failed. Resolves the handle, 
+	calls the user's callback and releases the batch's events and state.
+*/
+void CL_CALLBACK AsyncSubmission::OnReadComplete(cl_event, cl_int status, void* userData)
+{
+	AsyncBatchState* state = (AsyncBatchState*)userData;
+
+	/* Negative statuses are errors; CL_COMPLETE means the batch succeeded. */
+	cl_int result = (status < 0) ? status : CL_SUCCESS;
+
+	if (state->onComplete)
+	{
+		state->onComplete(result);
+	}
+	state->promise.set_value(result);
+
+	for (cl_event eachEvent : state->events)
+	{
+		if (eachEvent)
+		{
+			clReleaseEvent(eachEvent);
+		}
+	}
+
+	delete state;
+}
@@ -0,0 +1,90 @@
+/*===================================================================================*//**
+	AsyncSubmission
+	
+	Non-blocking submission of write, kernel and read batches, completed through 
+	cl_event callbacks instead of clFinish.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see AsyncSubmission
+	@see AsyncSubmission.cpp
+	
+*//*====================================================================================*/
+
+#ifndef ASYNC_SUBMISSION_H
+#define ASYNC_SUBMISSION_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <CL/cl.h>
+
+/*========================================================================================
+	Types
+========================================================================================*/
+/**
+	Called once a submitted batch has finished, with CL_SUCCESS or the error that ended 
+	it. Runs on an OpenCL runtime thread, so it must be short and thread-safe.
+*/
+typedef std::function<void(cl_int status)> CompletionCallback;
+
+/*========================================================================================
+	AsyncHandle	
+========================================================================================*/
+/**
+	Handle to a batch that was submitted without blocking.
+	
+	@see AsyncSubmission
+*/
+class AsyncHandle
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::shared_future<cl_int> _future;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		AsyncHandle();
+		AsyncHandle(std::shared_future<cl_int> future);
+		bool IsValid() const;
+		bool IsReady() const;
+		cl_int Wait() const;
+		std::shared_future<cl_int> GetFuture() const;
+};
+
+/*========================================================================================
+	AsyncSubmission	
+========================================================================================*/
+/**
+	Static class for submitting batches to a command queue without blocking the host.
+	
+	@see AsyncSubmission.cpp
+*/
+class AsyncSubmission
+{
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static AsyncHandle Submit(
+			cl_command_queue commandQueue, cl_kernel kernel, 
+			cl_mem input, cl_mem output, 
+			const cl_float4* hostInput, cl_float4* hostOutput, 
+			size_t firstPixel, size_t numPixels, size_t localSize, 
+			CompletionCallback onComplete = nullptr);
+		static cl_int WaitAll(const AsyncHandle* handles, size_t numHandles);
+
+    private:
+		static void CL_CALLBACK OnReadComplete(cl_event event, cl_int status, void* userData);
+};
+
+#endif
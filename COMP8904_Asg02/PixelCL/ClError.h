@@ -0,0 +1,41 @@
+/*===================================================================================*//**
+	ClError
+	
+	Names for OpenCL status codes, so failures can say what went wrong.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see ClError
+	@see ClError.cpp
+	
+*//*====================================================================================*/
+
+#ifndef CL_ERROR_H
+#define CL_ERROR_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <string>
+#include <CL/cl.h>
+
+/*========================================================================================
+	ClError	
+========================================================================================*/
+/**
+	Static class mapping OpenCL status codes to their names.
+	
+	@see ClError.cpp
+*/
+class ClError
+{
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static std::string GetName(cl_int status);
+};
+
+#endif
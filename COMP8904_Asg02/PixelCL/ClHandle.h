@@ -0,0 +1,211 @@
+/*===================================================================================*//**
+	ClHandle
+	
+	Move-only owners for OpenCL objects, releasing them when they go out of scope.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see ClHandle
+	
+*//*====================================================================================*/
+
+#ifndef CL_HANDLE_H
+#define CL_HANDLE_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <CL/cl.h>
+
+/*========================================================================================
+	ClHandleTraits
+========================================================================================*/
+/**
+	The retain and release functions for each kind of OpenCL object.
+*/
+template <typename T>
+struct ClHandleTraits;
+
+template <>
+struct ClHandleTraits<cl_context>
+{
+	static cl_int Retain(cl_context handle) { return clRetainContext(handle); }
+	static cl_int Release(cl_context handle) { return clReleaseContext(handle); }
+};
+
+template <>
+struct ClHandleTraits<cl_command_queue>
+{
+	static cl_int Retain(cl_command_queue handle) { return clRetainCommandQueue(handle); }
+	static cl_int Release(cl_command_queue handle) { return clReleaseCommandQueue(handle); }
+};
+
+template <>
+struct ClHandleTraits<cl_program>
+{
+	static cl_int Retain(cl_program handle) { return clRetainProgram(handle); }
+	static cl_int Release(cl_program handle) { return clReleaseProgram(handle); }
+};
+
+template <>
+struct ClHandleTraits<cl_kernel>
+{
+	static cl_int Retain(cl_kernel handle) { return clRetainKernel(handle); }
+	static cl_int Release(cl_kernel handle) { return clReleaseKernel(handle); }
+};
+
+template <>
+struct ClHandleTraits<cl_mem>
+{
+	static cl_int Retain(cl_mem handle) { return clRetainMemObject(handle); }
+	static cl_int Release(cl_mem handle) { return clReleaseMemObject(handle); }
+};
+
+template <>
+struct ClHandleTraits<cl_event>
+{
+	static cl_int Retain(cl_event handle) { return clRetainEvent(handle); }
+	static cl_int Release(cl_event handle) { return clReleaseEvent(handle); }
+};
+
+/*========================================================================================
+	ClHandle
+========================================================================================*/
+/**
+	Owns one reference to an OpenCL object and releases it when destroyed.
+	
+	A handle takes over the reference returned by a clCreate call. It converts to the 
+	raw object so it can be passed straight to the OpenCL API, and Share retains the 
+	object for a second owner. Handles can be moved but not copied, so each reference 
+	is released exactly once whichever path a function returns by.
+*/
+template <typename T>
+class ClHandle
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		T _handle;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		/**
+			Creates an empty handle.
+		*/
+		ClHandle() : _handle(nullptr)
+		{
+		}
+
+		/**
+			Takes over a reference the caller already holds, such as one returned by a 
+			clCreate call.
+		*/
+		explicit ClHandle(T handle) : _handle(handle)
+		{
+		}
+
+		/**
+			Releases the reference, if any.
+		*/
+		~ClHandle()
+		{
+			Reset();
+		}
+
+		ClHandle(const ClHandle&) = delete;
+		ClHandle& operator=(const ClHandle&) = delete;
+
+		/**
+			Takes over the other handle's reference, leaving it empty.
+		*/
+		ClHandle(ClHandle&& other) noexcept : _handle(other._handle)
+		{
+			other._handle = nullptr;
+		}
+
+		/**
+			Releases this handle's reference and takes over the other's.
+		*/
+		ClHandle& operator=(ClHandle&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Reset(other._handle);
+				other._handle = nullptr;
+			}
+			return *this;
+		}
+
+		/**
+			Returns the object without giving up the reference.
+		*/
+		T Get() const
+		{
+			return _handle;
+		}
+
+		/**
+			Returns the address of the object, for clSetKernelArg.
+		*/
+		const T* GetAddress() const
+		{
+			return &_handle;
+		}
+
+		operator T() const
+		{
+			return _handle;
+		}
+
+		/**
+			Returns another handle to the same object, holding its own reference.
+		*/
+		ClHandle Share() const
+		{
+			if (_handle)
+			{
+				ClHandleTraits<T>::Retain(_handle);
+			}
+			return ClHandle(_handle);
+		}
+
+		/**
+			Releases the current reference, if any, and takes over the given one.
+		*/
+		void Reset(T handle = nullptr)
+		{
+			if (_handle)
+			{
+				ClHandleTraits<T>::Release(_handle);
+			}
+			_handle = handle;
+		}
+
+		/**
+			Gives up the reference without releasing it and returns the object. The 
+			caller must release it.
+		*/
+		T Detach()
+		{
+			T handle = _handle;
+			_handle = nullptr;
+			return handle;
+		}
+};
+
+/*========================================================================================
+	Handle Types
+========================================================================================*/
+typedef ClHandle<cl_context> ClContext;
+typedef ClHandle<cl_command_queue> ClCommandQueue;
+typedef ClHandle<cl_program> ClProgram;
+typedef ClHandle<cl_kernel> ClKernel;
+typedef ClHandle<cl_mem> ClMem;
+typedef ClHandle<cl_event> ClEvent;
+
+#endif
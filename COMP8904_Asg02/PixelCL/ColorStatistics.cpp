@@ -0,0 +1,283 @@
+/*===================================================================================*//**
+	ColorStatistics
+	
+	Per-channel min, max, mean and variance for a collection of pixels, gathered in a 
+	single fused pass on either the host or an OpenCL device.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see ColorStatistics
+	@see ColorStatistics.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "ColorStatistics.h"
+#include "ClHandle.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+/*----------------------------------------------------------------------------------------
+	Constants
+----------------------------------------------------------------------------------------*/
+/** 
+	Number of pixels the host gathers before merging into the running totals. Small 
+	enough that the second pass over a chunk is served from L1.
+*/
+const size_t HOST_CHUNK_SIZE = 1024;
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates empty statistics.
+*/
+ColorStatistics::ColorStatistics()
+{
+	count = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		mean[i] = 0;
+		m2[i] = 0;
+		min[i] = std::numeric_limits<float>::max();
+		max[i] = -std::numeric_limits<float>::max();
+	}
+}
+
+/**
+	Adds a single pixel using Welford's update.
+*/
+void ColorStatistics::Add(const cl_float4& pixel)
+{
+	count++;
+
+	for (int i = 0; i < 4; i++)
+	{
+		double value = pixel.s[i];
+		double delta = value - mean[i];
+		mean[i] += delta / count;
+		m2[i] += delta * (value - mean[i]);
+		min[i] = std::min(min[i], pixel.s[i]);
+		max[i] = std::max(max[i], pixel.s[i]);
+	}
+}
+
+/**
+	Merges another set of statistics into this one using Chan's parallel formula.
+*/
+void ColorStatistics::Merge(const ColorStatistics& other)
+{
+	if (other.count == 0)
+	{
+		return;
+	}
+
+	if (count == 0)
+	{
+		*this = other;
+		return;
+	}
+
+	double total = (double)count + other.count;
+	double weight = other.count / total;
+	double crossWeight = ((double)count * other.count) / total;
+
+	for (int i = 0; i < 4; i++)
+	{
+		double delta = other.mean[i] - mean[i];
+		mean[i] += delta * weight;
+		m2[i] += other.m2[i] + delta * delta * crossWeight;
+		min[i] = std::min(min[i], other.min[i]);
+		max[i] = std::max(max[i], other.max[i]);
+	}
+
+	count += other.count;
+}
+
+/**
+	Merges the partial statistics of one device work-group into this one.
+*/
+void ColorStatistics::Merge(const ColorPartial& partial)
+{
+	ColorStatistics other;
+	other.count = partial.count;
+
+	for (int i = 0; i < 4; i++)
+	{
+		other.mean[i] = partial.mean.s[i];
+		other.m2[i] = partial.m2.s[i];
+		other.min[i] = partial.min.s[i];
+		other.max[i] = partial.max.s[i];
+	}
+
+	Merge(other);
+}
+
+/**
+	Returns the per-channel mean.
+*/
+cl_float4 ColorStatistics::GetMean() const
+{
+	return cl_float4{ (float)mean[0], (float)mean[1], (float)mean[2], (float)mean[3] };
+}
+
+/**
+	Returns the per-channel population variance.
+*/
+cl_float4 ColorStatistics::GetVariance() const
+{
+	if (count == 0)
+	{
+		return cl_float4{ 0, 0, 0, 0 };
+	}
+
+	return cl_float4{ 
+		(float)(m2[0] / count), (float)(m2[1] / count), 
+		(float)(m2[2] / count), (float)(m2[3] / count) };
+}
+
+/**
+	Returns the per-channel minimum.
+*/
+cl_float4 ColorStatistics::GetMin() const
+{
+	return cl_float4{ min[0], min[1], min[2], min[3] };
+}
+
+/**
+	Returns the per-channel maximum.
+*/
+cl_float4 ColorStatistics::GetMax() const
+{
+	return cl_float4{ max[0], max[1], max[2], max[3] };
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Computes the statistics of the given pixels on the host in a single pass.
+	
+	Pixels are taken in small chunks. Each chunk's sum, min and max are gathered as it 
+	is read, its squared deviations are then summed from cache, and the chunk is merged 
+	into the running totals. Main memory is only read once.
+*/
+ColorStatistics ColorStatistics::Compute(const cl_float4* pixels, size_t numPixels)
+{
+	ColorStatistics statistics;
+
+	for (size_t start = 0; start < numPixels; start += HOST_CHUNK_SIZE)
+	{
+		size_t end = std::min(start + HOST_CHUNK_SIZE, numPixels);
+		ColorStatistics chunk;
+		chunk.count = end - start;
+
+		double sum[4] = { 0, 0, 0, 0 };
+		for (size_t p = start; p < end; p++)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				sum[i] += pixels[p].s[i];
+				chunk.min[i] = std::min(chunk.min[i], pixels[p].s[i]);
+				chunk.max[i] = std::max(chunk.max[i], pixels[p].s[i]);
+			}
+		}
+
+		for (int i = 0; i < 4; i++)
+		{
+			chunk.mean[i] = sum[i] / chunk.count;
+		}
+
+		for (size_t p = start; p < end; p++)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				double delta = pixels[p].s[i] - chunk.mean[i];
+				chunk.m2[i] += delta * delta;
+			}
+		}
+
+		statistics.Merge(chunk);
+	}
+
+	return statistics;
+}
+
+/**
+	Computes the statistics of a device buffer with the computeColorStatistics kernel.
+	
+	Each work-group reduces its share of the pixels to one ColorPartial, and the partials 
+	are merged on the host in double precision. Returns the first OpenCL error hit, or 
+	CL_SUCCESS.
+*/
+cl_int ColorStatistics::ComputeOnDevice(
+	cl_context context, cl_command_queue commandQueue, cl_kernel kernel, 
+	cl_mem pixels, cl_uint numPixels, 
+	size_t localSize, size_t numGroups, 
+	ColorStatistics& statistics)
+{
+	cl_int result = 0;
+	size_t globalSize = localSize * numGroups;
+	size_t partialsSize = sizeof(ColorPartial) * numGroups;
+
+	ClMem clPartials(clCreateBuffer(
+		context, CL_MEM_WRITE_ONLY,
+		partialsSize, NULL,
+		&result
+	));
+
+	if (result != CL_SUCCESS)
+	{
+		return result;
+	}
+
+	/* Set kernel arguments. */
+	result = clSetKernelArg(kernel, 0, sizeof(cl_mem), &pixels);
+	result |= clSetKernelArg(kernel, 1, sizeof(cl_uint), &numPixels);
+	result |= clSetKernelArg(kernel, 2, sizeof(cl_mem), clPartials.GetAddress());
+	result |= clSetKernelArg(kernel, 3, sizeof(ColorPartial) * localSize, NULL);
+
+	if (result == CL_SUCCESS)
+	{
+		result = clEnqueueNDRangeKernel(
+			commandQueue, kernel,
+			1, NULL,
+			&globalSize, &localSize,
+			0, NULL,
+			NULL
+		);
+	}
+
+	/* Read back and merge the per-group partials. */
+	std::vector<ColorPartial> partials(numGroups);
+
+	if (result == CL_SUCCESS)
+	{
+		result = clEnqueueReadBuffer(
+			commandQueue, clPartials,
+			CL_TRUE, 0,
+			partialsSize, partials.data(),
+			0, NULL,
+			NULL
+		);
+	}
+
+	if (result != CL_SUCCESS)
+	{
+		return result;
+	}
+
+	statistics = ColorStatistics();
+	for (const ColorPartial& eachPartial : partials)
+	{
+		statistics.Merge(eachPartial);
+	}
+
+	return CL_SUCCESS;
+}
@@ -0,0 +1,92 @@
+/*===================================================================================*//**
+	ColorStatistics
+	
+	Per-channel min, max, mean and variance for a collection of pixels, gathered in a 
+	single fused pass on either the host or an OpenCL device.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see ColorStatistics
+	@see ColorStatistics.cpp
+	
+*//*====================================================================================*/
+
+#ifndef COLOR_STATISTICS_H
+#define COLOR_STATISTICS_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include <CL/cl.h>
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	Partial statistics written by one work-group of the computeColorStatistics kernel.
+	
+	Must match the layout of ColorPartial in Kernel.cl.
+*/
+struct ColorPartial
+{
+	public:
+		cl_float4 mean;
+		cl_float4 m2;
+		cl_float4 min;
+		cl_float4 max;
+		cl_uint count;
+		cl_uint padding[3];
+};
+
+/*========================================================================================
+	ColorStatistics	
+========================================================================================*/
+/**
+	Running per-channel statistics.
+	
+	Mean and variance are accumulated with Welford's update and combined with Chan's 
+	parallel merge, so the variance stays stable for hundreds of millions of pixels.
+	
+	@see ColorStatistics.cpp
+*/
+class ColorStatistics
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    public:
+		unsigned long long count;
+		double mean[4];
+		double m2[4];
+		float min[4];
+		float max[4];
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		ColorStatistics();
+		void Add(const cl_float4& pixel);
+		void Merge(const ColorStatistics& other);
+		void Merge(const ColorPartial& partial);
+		cl_float4 GetMean() const;
+		cl_float4 GetVariance() const;
+		cl_float4 GetMin() const;
+		cl_float4 GetMax() const;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static ColorStatistics Compute(const cl_float4* pixels, size_t numPixels);
+		static cl_int ComputeOnDevice(
+			cl_context context, cl_command_queue commandQueue, cl_kernel kernel, 
+			cl_mem pixels, cl_uint numPixels, 
+			size_t localSize, size_t numGroups, 
+			ColorStatistics& statistics);
+};
+
+#endif
@@ -0,0 +1,267 @@
+/*===================================================================================*//**
+	CommandGraph
+	
+	Builds event wait lists from declared buffer reads and writes, so that independent 
+	commands can overlap on an out-of-order command queue.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see CommandGraph
+	@see CommandGraph.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "CommandGraph.h"
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates an empty graph that enqueues onto the given queue.
+*/
+CommandGraph::CommandGraph(cl_command_queue commandQueue) : _commandQueue(commandQueue)
+{
+}
+
+/**
+	Waits for any outstanding commands and releases their events.
+*/
+CommandGraph::~CommandGraph()
+{
+	Finish();
+}
+
+/**
+	Enqueues a command that reads and writes the given buffer ranges. It waits on every 
+	earlier command it conflicts with. The enqueue function must pass the wait list on 
+	to its clEnqueue call and return the command's event.
+*/
+cl_int CommandGraph::Add(
+	const std::vector<BufferAccess>& reads, const std::vector<BufferAccess>& writes, 
+	Enqueue enqueue, size_t* nodeIndex)
+{
+	CommandNode node;
+	node.reads = reads;
+	node.writes = writes;
+	node.event = nullptr;
+
+	std::vector<cl_event> waitEvents;
+	for (size_t i = 0; i < _nodes.size(); i++)
+	{
+		if (_nodes[i].event && Conflicts(_nodes[i], reads, writes))
+		{
+			node.dependencies.push_back(i);
+			waitEvents.push_back(_nodes[i].event);
+		}
+	}
+
+	cl_int result = enqueue(
+		(cl_uint)waitEvents.size(), waitEvents.empty() ? NULL : waitEvents.data(),
+		&node.event
+	);
+
+	if (result != CL_SUCCESS)
+	{
+		return result;
+	}
+
+	_nodes.push_back(node);
+	if (nodeIndex)
+	{
+		*nodeIndex = _nodes.size() - 1;
+	}
+
+	return CL_SUCCESS;
+}
+
+/**
+	Enqueues a non-blocking write from host memory into a buffer range.
+*/
+cl_int CommandGraph::AddWrite(cl_mem buffer, size_t offset, size_t size, const void* hostPointer, size_t* nodeIndex)
+{
+	cl_command_queue commandQueue = _commandQueue;
+
+	return Add({}, { BufferAccess{ buffer, offset, size } }, 
+		[=](cl_uint numWaitEvents, const cl_event* waitEvents, cl_event* event)
+		{
+			return clEnqueueWriteBuffer(
+				commandQueue, buffer, CL_FALSE, offset, size, hostPointer, 
+				numWaitEvents, waitEvents, event);
+		}, 
+		nodeIndex);
+}
+
+/**
+	Enqueues a non-blocking read from a buffer range into host memory.
+*/
+cl_int CommandGraph::AddRead(cl_mem buffer, size_t offset, size_t size, void* hostPointer, size_t* nodeIndex)
+{
+	cl_command_queue commandQueue = _commandQueue;
+
+	return Add({ BufferAccess{ buffer, offset, size } }, {}, 
+		[=](cl_uint numWaitEvents, const cl_event* waitEvents, cl_event* event)
+		{
+			return clEnqueueReadBuffer(
+				commandQueue, buffer, CL_FALSE, offset, size, hostPointer, 
+				numWaitEvents, waitEvents, event);
+		}, 
+		nodeIndex);
+}
+
+/**
+	Binds the given buffers to the kernel's leading arguments and enqueues a 1D launch. 
+	Arguments are captured at enqueue time, so the same kernel can be added again with 
+	different buffers. If localSize does not divide globalSize the runtime picks the 
+	work-group size.
+*/
+cl_int CommandGraph::AddKernel(
+	cl_kernel kernel, const std::vector<cl_mem>& arguments, 
+	const std::vector<BufferAccess>& reads, const std::vector<BufferAccess>& writes, 
+	size_t globalOffset, size_t globalSize, size_t localSize, 
+	size_t* nodeIndex)
+{
+	cl_command_queue commandQueue = _commandQueue;
+
+	return Add(reads, writes, 
+		[&](cl_uint numWaitEvents, const cl_event* waitEvents, cl_event* event)
+		{
+			cl_int result = CL_SUCCESS;
+			for (size_t i = 0; i < arguments.size(); i++)
+			{
+				result |= clSetKernelArg(kernel, (cl_uint)i, sizeof(cl_mem), &arguments[i]);
+			}
+
+			if (result != CL_SUCCESS)
+			{
+				return result;
+			}
+
+			const size_t* localSizePtr = (localSize != 0 && globalSize % localSize == 0) ? &localSize : NULL;
+			return clEnqueueNDRangeKernel(
+				commandQueue, kernel, 
+				1, &globalOffset, 
+				&globalSize, localSizePtr, 
+				numWaitEvents, waitEvents, event);
+		}, 
+		nodeIndex);
+}
+
+/**
+	Waits for every command in the graph, releases their events and empties the graph. 
+	Returns the first error a command reported, or CL_SUCCESS.
+*/
+cl_int CommandGraph::Finish()
+{
+	cl_int firstError = CL_SUCCESS;
+
+	if (!_nodes.empty())
+	{
+		clFlush(_commandQueue);
+	}
+
+	for (CommandNode& eachNode : _nodes)
+	{
+		cl_int result = clWaitForEvents(1, &eachNode.event);
+
+		if (result != CL_SUCCESS && firstError == CL_SUCCESS)
+		{
+			firstError = result;
+		}
+
+		clReleaseEvent(eachNode.event);
+	}
+
+	_nodes.clear();
+	return firstError;
+}
+
+/**
+	Returns the commands added since the last Finish, with their derived dependencies.
+*/
+const std::vector<CommandNode>& CommandGraph::GetNodes() const
+{
+	return _nodes;
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates a command queue, asking for out-of-order execution if outOfOrder is set. 
+	Falls back to an in-order queue when the device does not support it. isOutOfOrder, 
+	if given, reports which kind was created.
+*/
+cl_command_queue CommandGraph::CreateCommandQueue(
+	cl_context context, cl_device_id device, 
+	bool outOfOrder, bool* isOutOfOrder, cl_int* result)
+{
+	cl_command_queue_properties supported = 0;
+	clGetDeviceInfo(device, CL_DEVICE_QUEUE_PROPERTIES, sizeof(supported), &supported, nullptr);
+
+	cl_command_queue_properties properties = 0;
+	if (outOfOrder && (supported & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE))
+	{
+		properties |= CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+	}
+
+	if (isOutOfOrder)
+	{
+		*isOutOfOrder = (properties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) != 0;
+	}
+
+	return clCreateCommandQueue(context, device, properties, result);
+}
+
+/**
+	Returns whether two accesses touch overlapping bytes of the same buffer.
+*/
+bool CommandGraph::Overlaps(const BufferAccess& a, const BufferAccess& b)
+{
+	return a.buffer == b.buffer && 
+		a.offset < b.offset + b.size && 
+		b.offset < a.offset + a.size;
+}
+
+/**
+	Returns whether a new command with the given accesses must wait on an earlier one.
+*/
+bool CommandGraph::Conflicts(const CommandNode& earlier, 
+	const std::vector<BufferAccess>& reads, const std::vector<BufferAccess>& writes)
+{
+	for (const BufferAccess& eachWrite : writes)
+	{
+		for (const BufferAccess& earlierWrite : earlier.writes)
+		{
+			if (Overlaps(eachWrite, earlierWrite))
+			{
+				return true;
+			}
+		}
+
+		for (const BufferAccess& earlierRead : earlier.reads)
+		{
+			if (Overlaps(eachWrite, earlierRead))
+			{
+				return true;
+			}
+		}
+	}
+
+	for (const BufferAccess& eachRead : reads)
+	{
+		for (const BufferAccess& earlierWrite : earlier.writes)
+		{
+			if (Overlaps(eachRead, earlierWrite))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
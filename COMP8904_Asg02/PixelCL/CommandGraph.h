@@ -0,0 +1,114 @@
+/*===================================================================================*//**
+	CommandGraph
+	
+	Builds event wait lists from declared buffer reads and writes, so that independent 
+	commands can overlap on an out-of-order command queue.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see CommandGraph
+	@see CommandGraph.cpp
+	
+*//*====================================================================================*/
+
+#ifndef COMMAND_GRAPH_H
+#define COMMAND_GRAPH_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include <CL/cl.h>
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	A byte range of a buffer that a command reads or writes.
+*/
+struct BufferAccess
+{
+	public:
+		cl_mem buffer;
+		size_t offset;
+		size_t size;
+};
+
+/**
+	A command that has been added to the graph.
+*/
+struct CommandNode
+{
+	public:
+		std::vector<BufferAccess> reads;
+		std::vector<BufferAccess> writes;
+		std::vector<size_t> dependencies;
+		cl_event event;
+};
+
+/*========================================================================================
+	CommandGraph	
+========================================================================================*/
+/**
+	Enqueues commands with wait lists derived from their buffer accesses.
+	
+	A command waits on every earlier command it conflicts with: read after write, write 
+	after read, or write after write on overlapping byte ranges of the same buffer. 
+	Commands with no conflicts get empty wait lists and are free to overlap.
+	
+	@see CommandGraph.cpp
+*/
+class CommandGraph
+{
+	/*------------------------------------------------------------------------------------
+		Types
+	------------------------------------------------------------------------------------*/
+    public:
+		typedef std::function<cl_int(cl_uint numWaitEvents, const cl_event* waitEvents, cl_event* event)> Enqueue;
+
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		cl_command_queue _commandQueue;
+		std::vector<CommandNode> _nodes;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		CommandGraph(cl_command_queue commandQueue);
+		~CommandGraph();
+		CommandGraph(const CommandGraph&) = delete;
+		CommandGraph& operator=(const CommandGraph&) = delete;
+
+		cl_int Add(
+			const std::vector<BufferAccess>& reads, const std::vector<BufferAccess>& writes, 
+			Enqueue enqueue, size_t* nodeIndex = nullptr);
+		cl_int AddWrite(cl_mem buffer, size_t offset, size_t size, const void* hostPointer, size_t* nodeIndex = nullptr);
+		cl_int AddRead(cl_mem buffer, size_t offset, size_t size, void* hostPointer, size_t* nodeIndex = nullptr);
+		cl_int AddKernel(
+			cl_kernel kernel, const std::vector<cl_mem>& arguments, 
+			const std::vector<BufferAccess>& reads, const std::vector<BufferAccess>& writes, 
+			size_t globalOffset, size_t globalSize, size_t localSize, 
+			size_t* nodeIndex = nullptr);
+		cl_int Finish();
+		const std::vector<CommandNode>& GetNodes() const;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static cl_command_queue CreateCommandQueue(
+			cl_context context, cl_device_id device, 
+			bool outOfOrder, bool* isOutOfOrder, cl_int* result);
+		static bool Overlaps(const BufferAccess& a, const BufferAccess& b);
+		static bool Conflicts(const CommandNode& earlier, 
+			const std::vector<BufferAccess>& reads, const std::vector<BufferAccess>& writes);
+};
+
+#endif
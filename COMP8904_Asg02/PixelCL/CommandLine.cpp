@@ -0,0 +1,178 @@
+/*===================================================================================*//**
+	CommandLine
+	
+	Static class for reading options from the command line, the environment and an 
+	optional config file, in that order of precedence.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see CommandLine
+	@see CommandLine.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "CommandLine.h"
+#include <cstdlib>
+#include <fstream>
+
+/*----------------------------------------------------------------------------------------
+	Class Fields
+----------------------------------------------------------------------------------------*/
+std::map<std::string, std::string> CommandLine::_configValues;
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Loads "name = value" lines from a config file, where name is an option without its 
+	leading dashes. Blank lines and lines starting with '#' are skipped. Options not 
+	given on the command line or in the environment fall back to these values. Returns 
+	false if the file cannot be read or has a line without '='.
+*/
+bool CommandLine::LoadConfigFile(const std::string& path)
+{
+	std::ifstream file(path);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	const char* whitespace = " \t\r";
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		size_t first = line.find_first_not_of(whitespace);
+
+		if (first == std::string::npos || line[first] == '#')
+		{
+			continue;
+		}
+
+		size_t equals = line.find('=');
+
+		if (equals == std::string::npos)
+		{
+			return false;
+		}
+
+		std::string name = line.substr(first, equals - first);
+		std::string value = line.substr(equals + 1);
+		name.erase(name.find_last_not_of(whitespace) + 1);
+		value.erase(0, value.find_first_not_of(whitespace));
+		value.erase(value.find_last_not_of(whitespace) + 1);
+		_configValues[name] = value;
+	}
+
+	return true;
+}
+
+/**
+	Returns the value of an option given as "--name=value" or "--name value". If it is 
+	not on the command line, falls back to the named environment variable and then the 
+	config file. Returns an empty string if none of them set it.
+*/
+std::string CommandLine::GetOption(int argc, char* argv[], const std::string& name, const char* environmentName)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string eachArgument = argv[i];
+
+		if (eachArgument.compare(0, name.size() + 1, name + "=") == 0)
+		{
+			return eachArgument.substr(name.size() + 1);
+		}
+
+		if (eachArgument == name && i + 1 < argc)
+		{
+			return argv[i + 1];
+		}
+	}
+
+	std::string value = environmentName ? GetEnvironment(environmentName) : "";
+	return value.empty() ? GetConfigValue(name) : value;
+}
+
+/**
+	Returns whether a flag was given on the command line, or its environment variable or 
+	config file value is set to something other than "0".
+*/
+bool CommandLine::HasFlag(int argc, char* argv[], const std::string& name, const char* environmentName)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (name == argv[i])
+		{
+			return true;
+		}
+	}
+
+	std::string value = environmentName ? GetEnvironment(environmentName) : "";
+
+	if (value.empty())
+	{
+		value = GetConfigValue(name);
+	}
+
+	return !value.empty() && value != "0";
+}
+
+/**
+	Returns whether an option was given on the command line or in the environment, 
+	rather than only in the config file.
+*/
+bool CommandLine::IsGiven(int argc, char* argv[], const std::string& name, const char* environmentName)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string eachArgument = argv[i];
+
+		if (eachArgument == name || eachArgument.compare(0, name.size() + 1, name + "=") == 0)
+		{
+			return true;
+		}
+	}
+
+	return environmentName && !GetEnvironment(environmentName).empty();
+}
+
+/**
+	Returns the value of an environment variable, or an empty string if it is not set.
+*/
+std::string CommandLine::GetEnvironment(const char* name)
+{
+#ifdef _MSC_VER
+	char* value = nullptr;
+	size_t length = 0;
+
+	if (_dupenv_s(&value, &length, name) != 0 || value == nullptr)
+	{
+		return "";
+	}
+
+	std::string result = value;
+	free(value);
+	return result;
+#else
+	const char* value = getenv(name);
+	return value ? value : "";
+#endif
+}
+
+/**
+	Returns the config file value for an option, looked up without its leading dashes, 
+	or an empty string if the file did not set it.
+*/
+std::string CommandLine::GetConfigValue(const std::string& name)
+{
+	size_t start = name.find_first_not_of('-');
+	std::map<std::string, std::string>::const_iterator found = 
+		_configValues.find((start == std::string::npos) ? name : name.substr(start));
+	return (found == _configValues.end()) ? "" : found->second;
+}
@@ -0,0 +1,56 @@
+/*===================================================================================*//**
+	CommandLine
+	
+	Static class for reading options from the command line, the environment and an 
+	optional config file, in that order of precedence.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see CommandLine
+	@see CommandLine.cpp
+	
+*//*====================================================================================*/
+
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <map>
+#include <string>
+
+/*========================================================================================
+	CommandLine	
+========================================================================================*/
+/**
+	Static class for reading options from the command line, the environment and an 
+	optional config file, in that order of precedence.
+	
+	@see CommandLine.cpp
+*/
+class CommandLine
+{
+    /*------------------------------------------------------------------------------------
+		Class Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		static std::map<std::string, std::string> _configValues;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static bool LoadConfigFile(const std::string& path);
+		static std::string GetOption(int argc, char* argv[], const std::string& name, const char* environmentName);
+		static bool HasFlag(int argc, char* argv[], const std::string& name, const char* environmentName);
+		static bool IsGiven(int argc, char* argv[], const std::string& name, const char* environmentName);
+		static std::string GetEnvironment(const char* name);
+
+    private:
+		static std::string GetConfigValue(const std::string& name);
+};
+
+#endif
@@ -0,0 +1,336 @@
+/*===================================================================================*//**
+	DeviceArena
+	
+	Device memory arena that carves a few large OpenCL buffers into sub-buffers, so 
+	batches can reuse device memory instead of creating and releasing buffers each time.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see DeviceArena
+	@see DeviceArena.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "DeviceArena.h"
+#include <algorithm>
+
+/*----------------------------------------------------------------------------------------
+	Constants
+----------------------------------------------------------------------------------------*/
+/** Slab index of a region that has a buffer of its own rather than part of a slab. */
+const size_t UNPOOLED_SLAB = (size_t)-1;
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates an arena that is not yet tied to a context.
+*/
+DeviceArena::DeviceArena()
+	: _context(nullptr), 
+	_flags(CL_MEM_READ_WRITE), 
+	_slabSize(0), 
+	_alignment(1), 
+	_maxAllocation(0), 
+	_statistics()
+{
+}
+
+/**
+	Releases every sub-buffer and slab.
+*/
+DeviceArena::~DeviceArena()
+{
+	Release();
+}
+
+/**
+	Ties the arena to a context. Slabs are created with the given flags and are 
+	slabSize bytes, or bigger when a single request needs it. Regions are aligned to the 
+	largest CL_DEVICE_MEM_BASE_ADDR_ALIGN of the context's devices, and no slab is 
+	larger than the smallest CL_DEVICE_MAX_MEM_ALLOC_SIZE.
+*/
+cl_int DeviceArena::Initialize(cl_context context, cl_mem_flags flags, size_t slabSize)
+{
+	Release();
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	size_t devicesSize = 0;
+	cl_int result = clGetContextInfo(context, CL_CONTEXT_DEVICES, 0, NULL, &devicesSize);
+
+	if (result != CL_SUCCESS || devicesSize == 0)
+	{
+		return (result != CL_SUCCESS) ? result : CL_INVALID_CONTEXT;
+	}
+
+	std::vector<cl_device_id> devices(devicesSize / sizeof(cl_device_id));
+	result = clGetContextInfo(context, CL_CONTEXT_DEVICES, devicesSize, devices.data(), NULL);
+
+	if (result != CL_SUCCESS)
+	{
+		return result;
+	}
+
+	_alignment = 1;
+	_maxAllocation = (size_t)-1;
+
+	for (cl_device_id eachDevice : devices)
+	{
+		/* The alignment is reported in bits. */
+		cl_uint alignBits = 0;
+		cl_ulong maxAllocation = 0;
+		result = clGetDeviceInfo(eachDevice, CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(cl_uint), &alignBits, NULL);
+		result |= clGetDeviceInfo(eachDevice, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(cl_ulong), &maxAllocation, NULL);
+
+		if (result != CL_SUCCESS)
+		{
+			return result;
+		}
+
+		_alignment = std::max(_alignment, (size_t)(alignBits / 8));
+		_maxAllocation = std::min(_maxAllocation, (size_t)maxAllocation);
+	}
+
+	_context = context;
+	_flags = flags;
+	_slabSize = std::min(((slabSize + _alignment - 1) / _alignment) * _alignment, _maxAllocation);
+	return CL_SUCCESS;
+}
+
+/**
+	Returns a sub-buffer of at least bytes bytes, reused from the free list of its size 
+	class when possible. A request that fits the device but whose size class does not 
+	gets a buffer of its own, of the exact aligned size, which is released rather than 
+	pooled when it is freed. Returns nullptr and sets errorCode on failure.
+*/
+cl_mem DeviceArena::Allocate(size_t bytes, cl_int* errorCode)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	*errorCode = CL_SUCCESS;
+
+	if (!_context)
+	{
+		*errorCode = CL_INVALID_CONTEXT;
+		return nullptr;
+	}
+
+	size_t capacity = GetSizeClass(bytes, _alignment);
+
+	if (capacity > _maxAllocation)
+	{
+		capacity = std::max((bytes + _alignment - 1) / _alignment, (size_t)1) * _alignment;
+
+		if (capacity > _maxAllocation)
+		{
+			*errorCode = CL_INVALID_BUFFER_SIZE;
+			return nullptr;
+		}
+
+		cl_mem buffer = clCreateBuffer(_context, _flags, capacity, NULL, errorCode);
+
+		if (*errorCode != CL_SUCCESS)
+		{
+			return nullptr;
+		}
+
+		ArenaRegion region = { buffer, UNPOOLED_SLAB, 0, capacity, bytes };
+		_inUse[buffer] = region;
+
+		_statistics.regionsCreated++;
+		_statistics.regionsInUse++;
+		_statistics.bytesInUse += capacity;
+		_statistics.bytesRequested += bytes;
+		_statistics.peakBytesInUse = std::max(_statistics.peakBytesInUse, _statistics.bytesInUse);
+		return buffer;
+	}
+
+	/* Reuse a region of the same class if one has been given back. */
+	std::vector<ArenaRegion>& freeList = _freeLists[capacity];
+
+	if (!freeList.empty())
+	{
+		ArenaRegion region = freeList.back();
+		freeList.pop_back();
+		region.requested = bytes;
+		_inUse[region.buffer] = region;
+
+		_statistics.reuses++;
+		_statistics.regionsInUse++;
+		_statistics.bytesFree -= capacity;
+		_statistics.bytesInUse += capacity;
+		_statistics.bytesRequested += bytes;
+		_statistics.peakBytesInUse = std::max(_statistics.peakBytesInUse, _statistics.bytesInUse);
+		return region.buffer;
+	}
+
+	/* Otherwise cut a new region from the first slab with room, creating one if needed. */
+	size_t slabIndex = 0;
+
+	while (slabIndex < _slabs.size() && _slabs[slabIndex].size - _slabs[slabIndex].used < capacity)
+	{
+		slabIndex++;
+	}
+
+	if (slabIndex == _slabs.size())
+	{
+		Slab slab = { nullptr, std::max(_slabSize, capacity), 0 };
+		slab.buffer = clCreateBuffer(_context, _flags, slab.size, NULL, errorCode);
+
+		if (*errorCode != CL_SUCCESS)
+		{
+			return nullptr;
+		}
+
+		_slabs.push_back(slab);
+		_statistics.slabs++;
+		_statistics.slabBytes += slab.size;
+	}
+
+	/* Sub-buffers created with no flags inherit the slab's. */
+	Slab& slab = _slabs[slabIndex];
+	cl_buffer_region bufferRegion = { slab.used, capacity };
+	cl_mem buffer = clCreateSubBuffer(slab.buffer, 0, CL_BUFFER_CREATE_TYPE_REGION, &bufferRegion, errorCode);
+
+	if (*errorCode != CL_SUCCESS)
+	{
+		return nullptr;
+	}
+
+	ArenaRegion region = { buffer, slabIndex, slab.used, capacity, bytes };
+	slab.used += capacity;
+	_inUse[buffer] = region;
+
+	_statistics.regionsCreated++;
+	_statistics.regionsInUse++;
+	_statistics.bytesInUse += capacity;
+	_statistics.bytesRequested += bytes;
+	_statistics.peakBytesInUse = std::max(_statistics.peakBytesInUse, _statistics.bytesInUse);
+	return buffer;
+}
+
+/**
+	Gives a region back to the free list of its size class, or releases it if it has a 
+	buffer of its own. Buffers the arena does not own are ignored.
+*/
+void DeviceArena::Free(cl_mem buffer)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::unordered_map<cl_mem, ArenaRegion>::iterator found = _inUse.find(buffer);
+
+	if (found == _inUse.end())
+	{
+		return;
+	}
+
+	ArenaRegion region = found->second;
+	_inUse.erase(found);
+
+	_statistics.regionsInUse--;
+	_statistics.bytesInUse -= region.capacity;
+	_statistics.bytesRequested -= region.requested;
+
+	if (region.slab == UNPOOLED_SLAB)
+	{
+		clReleaseMemObject(region.buffer);
+		return;
+	}
+
+	_freeLists[region.capacity].push_back(region);
+	_statistics.bytesFree += region.capacity;
+}
+
+/**
+	Releases every sub-buffer, whether in use or free, and then every slab.
+*/
+void DeviceArena::Release()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for (std::pair<const cl_mem, ArenaRegion>& eachRegion : _inUse)
+	{
+		clReleaseMemObject(eachRegion.second.buffer);
+	}
+
+	for (std::pair<const size_t, std::vector<ArenaRegion>>& eachList : _freeLists)
+	{
+		for (ArenaRegion& eachRegion : eachList.second)
+		{
+			clReleaseMemObject(eachRegion.buffer);
+		}
+	}
+
+	for (Slab& eachSlab : _slabs)
+	{
+		clReleaseMemObject(eachSlab.buffer);
+	}
+
+	_inUse.clear();
+	_freeLists.clear();
+	_slabs.clear();
+	_statistics = ArenaStatistics();
+}
+
+/**
+	Returns the alignment every region's offset and size is a multiple of.
+*/
+size_t DeviceArena::GetAlignment() const
+{
+	return _alignment;
+}
+
+/**
+	Returns a snapshot of the arena's counters.
+*/
+ArenaStatistics DeviceArena::GetStatistics()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _statistics;
+}
+
+/**
+	Writes the arena's counters in a readable form.
+*/
+void DeviceArena::Print(std::ostream& stream)
+{
+	ArenaStatistics statistics = GetStatistics();
+
+	stream << "Device arena:\n" << 
+		"\t" << statistics.slabs << " slabs, " << (statistics.slabBytes >> 10) << " KB\n" << 
+		"\t" << statistics.regionsInUse << " regions in use, " << (statistics.bytesInUse >> 10) << " KB (" << 
+		(statistics.bytesRequested >> 10) << " KB requested), peak " << (statistics.peakBytesInUse >> 10) << " KB\n" << 
+		"\t" << (statistics.bytesFree >> 10) << " KB on free lists, " << 
+		statistics.regionsCreated << " regions created, " << statistics.reuses << " reused\n\n";
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Rounds a request up to its size class for the given alignment. Up to four alignment 
+	units the class is exact; beyond that there are four classes per power of two, so 
+	rounding wastes at most a fifth of the region.
+*/
+size_t DeviceArena::GetSizeClass(size_t bytes, size_t alignment)
+{
+	size_t units = std::max((bytes + alignment - 1) / alignment, (size_t)1);
+
+	if (units <= 4)
+	{
+		return units * alignment;
+	}
+
+	size_t highestBit = 0;
+
+	while ((units >> (highestBit + 1)) != 0)
+	{
+		highestBit++;
+	}
+
+	size_t step = (size_t)1 << (highestBit - 2);
+	return ((units + step - 1) / step) * step * alignment;
+}
@@ -0,0 +1,131 @@
+/*===================================================================================*//**
+	DeviceArena
+	
+	Device memory arena that carves a few large OpenCL buffers into sub-buffers, so 
+	batches can reuse device memory instead of creating and releasing buffers each time.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see DeviceArena
+	@see DeviceArena.cpp
+	
+*//*====================================================================================*/
+
+#ifndef DEVICE_ARENA_H
+#define DEVICE_ARENA_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+#include <CL/cl.h>
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	A sub-buffer carved from one of the arena's slabs.
+*/
+struct ArenaRegion
+{
+	public:
+		cl_mem buffer;
+		size_t slab;
+		size_t offset;
+		size_t capacity;
+		size_t requested;
+};
+
+/**
+	Counters describing how much device memory the arena holds and hands out.
+*/
+struct ArenaStatistics
+{
+	public:
+		size_t slabs;
+		size_t slabBytes;
+		size_t bytesInUse;
+		size_t bytesRequested;
+		size_t bytesFree;
+		size_t peakBytesInUse;
+		size_t regionsInUse;
+		size_t regionsCreated;
+		size_t reuses;
+};
+
+/*========================================================================================
+	DeviceArena	
+========================================================================================*/
+/**
+	Thread-safe arena of device memory for one context.
+	
+	Requests are rounded up to a size class: a multiple of the largest 
+	CL_DEVICE_MEM_BASE_ADDR_ALIGN in the context, in quarter steps between powers of two. 
+	Each class has a free list of sub-buffers that have been given back. A new region is 
+	cut from the end of a slab, and a new slab is created when none has room. Requests 
+	whose size class would exceed CL_DEVICE_MAX_MEM_ALLOC_SIZE get an exact-size buffer 
+	of their own instead, so anything RunConfig::Validate accepts can be allocated.
+	
+	A region must not be freed while commands that use it are still pending.
+	
+	@see DeviceArena.cpp
+*/
+class DeviceArena
+{
+	/*------------------------------------------------------------------------------------
+		Structs
+	------------------------------------------------------------------------------------*/
+	private:
+		struct Slab
+		{
+			cl_mem buffer;
+			size_t size;
+			size_t used;
+		};
+
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::mutex _mutex;
+		cl_context _context;
+		cl_mem_flags _flags;
+		size_t _slabSize;
+		size_t _alignment;
+		size_t _maxAllocation;
+		std::vector<Slab> _slabs;
+		std::map<size_t, std::vector<ArenaRegion>> _freeLists;
+		std::unordered_map<cl_mem, ArenaRegion> _inUse;
+		ArenaStatistics _statistics;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		DeviceArena();
+		~DeviceArena();
+		DeviceArena(const DeviceArena&) = delete;
+		DeviceArena& operator=(const DeviceArena&) = delete;
+
+		cl_int Initialize(cl_context context, cl_mem_flags flags, size_t slabSize);
+		cl_mem Allocate(size_t bytes, cl_int* errorCode);
+		void Free(cl_mem buffer);
+		void Release();
+		size_t GetAlignment() const;
+		ArenaStatistics GetStatistics();
+		void Print(std::ostream& out);
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static size_t GetSizeClass(size_t bytes, size_t alignment);
+};
+
+#endif
@@ -0,0 +1,285 @@
+/*===================================================================================*//**
+	DeviceCoroutines
+	
+	C++20 coroutine front-end for chaining device operations. Each enqueue can be 
+	co_awaited, and a scheduler driven by cl_event callbacks resumes the waiting 
+	coroutines on a single thread.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see DeviceTask
+	@see DeviceOperation
+	@see DeviceScheduler
+	@see DeviceCoroutines.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "DeviceCoroutines.h"
+#include <exception>
+
+/*----------------------------------------------------------------------------------------
+	DeviceTask Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates the task object returned to the caller of a coroutine.
+*/
+DeviceTask DeviceTask::promise_type::get_return_object()
+{
+	return DeviceTask(std::coroutine_handle<promise_type>::from_promise(*this));
+}
+
+/**
+	Tasks start suspended so the scheduler decides where they run.
+*/
+std::suspend_always DeviceTask::promise_type::initial_suspend() noexcept
+{
+	return std::suspend_always();
+}
+
+/**
+	Stores the status the coroutine co_returned.
+*/
+void DeviceTask::promise_type::return_value(cl_int result)
+{
+	status.set_value(result);
+}
+
+/**
+	Hands any escaping exception to whoever waits on the task.
+*/
+void DeviceTask::promise_type::unhandled_exception()
+{
+	status.set_exception(std::current_exception());
+}
+
+/**
+	Takes ownership of a coroutine frame.
+*/
+DeviceTask::DeviceTask(std::coroutine_handle<promise_type> handle) : _handle(handle)
+{
+}
+
+/**
+	Moves ownership of the coroutine frame.
+*/
+DeviceTask::DeviceTask(DeviceTask&& other) noexcept : _handle(other._handle)
+{
+	other._handle = nullptr;
+}
+
+/**
+	Destroys the coroutine frame if the task was never spawned.
+*/
+DeviceTask::~DeviceTask()
+{
+	if (_handle)
+	{
+		_handle.destroy();
+	}
+}
+
+/**
+	Gives up ownership of the coroutine frame.
+*/
+std::coroutine_handle<DeviceTask::promise_type> DeviceTask::Release()
+{
+	std::coroutine_handle<promise_type> handle = _handle;
+	_handle = nullptr;
+	return handle;
+}
+
+/*----------------------------------------------------------------------------------------
+	DeviceOperation Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates an operation that will call the given enqueue function when awaited.
+*/
+DeviceOperation::DeviceOperation(DeviceScheduler* scheduler, cl_command_queue commandQueue, Enqueue enqueue) : 
+	_scheduler(scheduler), 
+	_commandQueue(commandQueue), 
+	_enqueue(enqueue), 
+	_status(CL_SUCCESS)
+{
+}
+
+/**
+	Operations always have to be enqueued first.
+*/
+bool DeviceOperation::await_ready() const noexcept
+{
+	return false;
+}
+
+/**
+	Enqueues the command and arranges for the coroutine to be resumed when it completes. 
+	If the enqueue itself fails the coroutine carries on straight away with the error.
+*/
+bool DeviceOperation::await_suspend(std::coroutine_handle<> handle)
+{
+	cl_event event = nullptr;
+	_handle = handle;
+	_status = _enqueue(&event);
+
+	if (_status != CL_SUCCESS)
+	{
+		return false;
+	}
+
+	/* The callback may resume the coroutine and destroy this object, so copy first. */
+	cl_command_queue commandQueue = _commandQueue;
+	cl_int result = clSetEventCallback(event, CL_COMPLETE, OnComplete, this);
+
+	if (result != CL_SUCCESS)
+	{
+		clWaitForEvents(1, &event);
+		clReleaseEvent(event);
+		_status = result;
+		return false;
+	}
+
+	clFlush(commandQueue);
+	return true;
+}
+
+/**
+	Returns the status of the command.
+*/
+cl_int DeviceOperation::await_resume() const noexcept
+{
+	return _status;
+}
+
+/**
+	Records the command's status and queues the waiting coroutine on the scheduler.
+*/
+void CL_CALLBACK DeviceOperation::OnComplete(cl_event event, cl_int status, void* userData)
+{
+	DeviceOperation* operation = (DeviceOperation*)userData;
+	operation->_status = (status < 0) ? status : CL_SUCCESS;
+	clReleaseEvent(event);
+	operation->_scheduler->Post(operation->_handle);
+}
+
+/*----------------------------------------------------------------------------------------
+	DeviceScheduler Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates a scheduler with no tasks.
+*/
+DeviceScheduler::DeviceScheduler() : _activeTasks(0)
+{
+}
+
+/**
+	Takes a task and queues it to start on the next call to Run. The returned handle 
+	receives the status the task co_returns.
+*/
+AsyncHandle DeviceScheduler::Spawn(DeviceTask task)
+{
+	std::coroutine_handle<DeviceTask::promise_type> handle = task.Release();
+	handle.promise().scheduler = this;
+	AsyncHandle result(handle.promise().status.get_future().share());
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_activeTasks++;
+	}
+	Post(handle);
+
+	return result;
+}
+
+/**
+	Resumes coroutines on the calling thread as their operations complete, returning 
+	once every spawned task has finished.
+*/
+void DeviceScheduler::Run()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while (_activeTasks > 0 || !_ready.empty())
+	{
+		if (_ready.empty())
+		{
+			_readyChanged.wait(lock);
+			continue;
+		}
+
+		std::coroutine_handle<> handle = _ready.front();
+		_ready.pop_front();
+
+		lock.unlock();
+		handle.resume();
+		lock.lock();
+	}
+}
+
+/**
+	Queues a coroutine to be resumed by Run. Safe to call from callback threads.
+*/
+void DeviceScheduler::Post(std::coroutine_handle<> handle)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_ready.push_back(handle);
+	}
+	_readyChanged.notify_one();
+}
+
+/**
+	Called by a task's final suspend once its frame has been destroyed.
+*/
+void DeviceScheduler::OnTaskFinished()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_activeTasks--;
+	}
+	_readyChanged.notify_one();
+}
+
+/**
+	Returns an awaitable non-blocking buffer write.
+*/
+DeviceOperation DeviceScheduler::Write(
+	cl_command_queue commandQueue, cl_mem buffer, 
+	size_t offset, size_t size, const void* hostPointer)
+{
+	return DeviceOperation(this, commandQueue, [=](cl_event* event)
+	{
+		return clEnqueueWriteBuffer(commandQueue, buffer, CL_FALSE, offset, size, hostPointer, 0, NULL, event);
+	});
+}
+
+/**
+	Returns an awaitable 1D kernel launch. If localSize does not divide globalSize the 
+	runtime picks the work-group size.
+*/
+DeviceOperation DeviceScheduler::Kernel(
+	cl_command_queue commandQueue, cl_kernel kernel, 
+	size_t globalOffset, size_t globalSize, size_t localSize)
+{
+	return DeviceOperation(this, commandQueue, [=](cl_event* event)
+	{
+		const size_t* localSizePtr = (localSize != 0 && globalSize % localSize == 0) ? &localSize : NULL;
+		return clEnqueueNDRangeKernel(commandQueue, kernel, 1, &globalOffset, &globalSize, localSizePtr, 0, NULL, event);
+	});
+}
+
+/**
+	Returns an awaitable non-blocking buffer read.
+*/
+DeviceOperation DeviceScheduler::Read(
+	cl_command_queue commandQueue, cl_mem buffer, 
+	size_t offset, size_t size, void* hostPointer)
+{
+	return DeviceOperation(this, commandQueue, [=](cl_event* event)
+	{
+		return clEnqueueReadBuffer(commandQueue, buffer, CL_FALSE, offset, size, hostPointer, 0, NULL, event);
+	});
+}
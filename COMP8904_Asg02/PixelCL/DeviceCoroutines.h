@@ -0,0 +1,184 @@
+/*===================================================================================*//**
+	DeviceCoroutines
+	
+	C++20 coroutine front-end for chaining device operations. Each enqueue can be 
+	co_awaited, and a scheduler driven by cl_event callbacks resumes the waiting 
+	coroutines on a single thread.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see DeviceTask
+	@see DeviceOperation
+	@see DeviceScheduler
+	@see DeviceCoroutines.cpp
+	
+*//*====================================================================================*/
+
+#ifndef DEVICE_COROUTINES_H
+#define DEVICE_COROUTINES_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <CL/cl.h>
+#include "AsyncSubmission.h"
+
+class DeviceScheduler;
+
+/*========================================================================================
+	DeviceTask	
+========================================================================================*/
+/**
+	Coroutine that chains device operations and co_returns a cl_int status.
+	
+	A task does not start until it is handed to DeviceScheduler::Spawn.
+*/
+class DeviceTask
+{
+	/*------------------------------------------------------------------------------------
+		Promise
+	------------------------------------------------------------------------------------*/
+    public:
+		struct promise_type
+		{
+			public:
+				DeviceScheduler* scheduler = nullptr;
+				std::promise<cl_int> status;
+
+				DeviceTask get_return_object();
+				std::suspend_always initial_suspend() noexcept;
+				auto final_suspend() noexcept;
+				void return_value(cl_int result);
+				void unhandled_exception();
+		};
+
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::coroutine_handle<promise_type> _handle;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		explicit DeviceTask(std::coroutine_handle<promise_type> handle);
+		DeviceTask(DeviceTask&& other) noexcept;
+		DeviceTask(const DeviceTask&) = delete;
+		DeviceTask& operator=(const DeviceTask&) = delete;
+		~DeviceTask();
+		std::coroutine_handle<promise_type> Release();
+};
+
+/*========================================================================================
+	DeviceOperation	
+========================================================================================*/
+/**
+	Awaitable wrapper around one enqueue. Awaiting it enqueues the command and suspends 
+	the coroutine until the command's event completes, then yields the command status.
+*/
+class DeviceOperation
+{
+	/*------------------------------------------------------------------------------------
+		Types
+	------------------------------------------------------------------------------------*/
+    public:
+		typedef std::function<cl_int(cl_event* event)> Enqueue;
+
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		DeviceScheduler* _scheduler;
+		cl_command_queue _commandQueue;
+		Enqueue _enqueue;
+		cl_int _status;
+		std::coroutine_handle<> _handle;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		DeviceOperation(DeviceScheduler* scheduler, cl_command_queue commandQueue, Enqueue enqueue);
+		bool await_ready() const noexcept;
+		bool await_suspend(std::coroutine_handle<> handle);
+		cl_int await_resume() const noexcept;
+
+    private:
+		static void CL_CALLBACK OnComplete(cl_event event, cl_int status, void* userData);
+};
+
+/*========================================================================================
+	DeviceScheduler	
+========================================================================================*/
+/**
+	Resumes device coroutines when their operations complete.
+	
+	Completion callbacks only queue the coroutine to be resumed. The thread that calls 
+	Run does all of the resuming, so no thread blocks for each operation in flight.
+*/
+class DeviceScheduler
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::mutex _mutex;
+		std::condition_variable _readyChanged;
+		std::deque<std::coroutine_handle<>> _ready;
+		size_t _activeTasks;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		DeviceScheduler();
+		AsyncHandle Spawn(DeviceTask task);
+		void Run();
+		void Post(std::coroutine_handle<> handle);
+		void OnTaskFinished();
+
+		DeviceOperation Write(
+			cl_command_queue commandQueue, cl_mem buffer, 
+			size_t offset, size_t size, const void* hostPointer);
+		DeviceOperation Kernel(
+			cl_command_queue commandQueue, cl_kernel kernel, 
+			size_t globalOffset, size_t globalSize, size_t localSize);
+		DeviceOperation Read(
+			cl_command_queue commandQueue, cl_mem buffer, 
+			size_t offset, size_t size, void* hostPointer);
+};
+
+/*----------------------------------------------------------------------------------------
+	Inline Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Hands the finished task back to the scheduler and destroys its frame.
+*/
+inline auto DeviceTask::promise_type::final_suspend() noexcept
+{
+	struct FinalAwaiter
+	{
+		bool await_ready() const noexcept { return false; }
+		void await_resume() const noexcept {}
+		void await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+		{
+			DeviceScheduler* scheduler = handle.promise().scheduler;
+			handle.destroy();
+			scheduler->OnTaskFinished();
+		}
+	};
+
+	return FinalAwaiter();
+}
+
+#endif
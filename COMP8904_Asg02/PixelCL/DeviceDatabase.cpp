@@ -0,0 +1,492 @@
+/*===================================================================================*//**
+	DeviceDatabase
+	
+	Discovers every OpenCL device on every platform, records its capabilities and ranks 
+	the devices by a configurable score or a quick bandwidth micro-benchmark.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see DeviceDatabase
+	@see DeviceDatabase.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "DeviceDatabase.h"
+#include "ClError.h"
+#include "ClHandle.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+/*----------------------------------------------------------------------------------------
+	Constants
+----------------------------------------------------------------------------------------*/
+/** Kernel used by the bandwidth micro-benchmark. */
+const char* COPY_KERNEL_SOURCE =
+	"__kernel void copyPixels(__global const float4* source, __global float4* destination)\n"
+	"{\n"
+	"	destination[get_global_id(0)] = source[get_global_id(0)];\n"
+	"}\n";
+
+/** Bytes copied by each run of the micro-benchmark. */
+const size_t BENCHMARK_BYTES = 16 * 1024 * 1024;
+
+/** Timed runs of the micro-benchmark, after one warm-up run. */
+const int BENCHMARK_RUNS = 3;
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Finds every device on every platform and records its capabilities.
+*/
+cl_int DeviceDatabase::Discover()
+{
+	_devices.clear();
+
+	cl_uint numPlatforms = 0;
+	cl_int result = clGetPlatformIDs(0, nullptr, &numPlatforms);
+
+	if (result != CL_SUCCESS || numPlatforms == 0)
+	{
+		return result;
+	}
+
+	std::vector<cl_platform_id> platforms(numPlatforms);
+	clGetPlatformIDs(numPlatforms, platforms.data(), nullptr);
+
+	for (size_t p = 0; p < platforms.size(); p++)
+	{
+		cl_uint numDevices = 0;
+		if (clGetDeviceIDs(platforms[p], CL_DEVICE_TYPE_ALL, 0, nullptr, &numDevices) != CL_SUCCESS)
+		{
+			continue;
+		}
+
+		std::vector<cl_device_id> devices(numDevices);
+		clGetDeviceIDs(platforms[p], CL_DEVICE_TYPE_ALL, numDevices, devices.data(), nullptr);
+
+		for (size_t d = 0; d < devices.size(); d++)
+		{
+			DeviceInfo info = DeviceInfo();
+			cl_bool hostUnifiedMemory = CL_FALSE;
+
+			info.platform = platforms[p];
+			info.device = devices[d];
+			info.platformIndex = p;
+			info.deviceIndex = d;
+			info.platformName = GetPlatformString(platforms[p], CL_PLATFORM_NAME);
+			info.name = GetDeviceString(devices[d], CL_DEVICE_NAME);
+			info.vendor = GetDeviceString(devices[d], CL_DEVICE_VENDOR);
+			info.version = GetDeviceString(devices[d], CL_DEVICE_VERSION);
+
+			clGetDeviceInfo(devices[d], CL_DEVICE_TYPE, sizeof(cl_device_type), &info.type, nullptr);
+			clGetDeviceInfo(devices[d], CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &info.computeUnits, nullptr);
+			clGetDeviceInfo(devices[d], CL_DEVICE_MAX_CLOCK_FREQUENCY, sizeof(cl_uint), &info.clockMHz, nullptr);
+			clGetDeviceInfo(devices[d], CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(cl_ulong), &info.globalMemory, nullptr);
+			clGetDeviceInfo(devices[d], CL_DEVICE_LOCAL_MEM_SIZE, sizeof(cl_ulong), &info.localMemory, nullptr);
+			clGetDeviceInfo(devices[d], CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(cl_ulong), &info.maxAllocation, nullptr);
+			clGetDeviceInfo(devices[d], CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE, sizeof(cl_ulong), &info.constantMemory, nullptr);
+			clGetDeviceInfo(devices[d], CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(cl_uint), &info.baseAddressAlignBits, nullptr);
+			clGetDeviceInfo(devices[d], CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(size_t), &info.maxWorkGroupSize, nullptr);
+			clGetDeviceInfo(devices[d], CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(cl_bool), &hostUnifiedMemory, nullptr);
+			clGetDeviceInfo(devices[d], CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT, sizeof(cl_uint), &info.preferredFloatWidth, nullptr);
+			clGetDeviceInfo(devices[d], CL_DEVICE_NATIVE_VECTOR_WIDTH_FLOAT, sizeof(cl_uint), &info.nativeFloatWidth, nullptr);
+			info.hostUnifiedMemory = (hostUnifiedMemory == CL_TRUE);
+
+			_devices.push_back(info);
+		}
+	}
+
+	Score(DeviceScoreWeights());
+	return CL_SUCCESS;
+}
+
+/**
+	Measures the copy bandwidth of every device with a short micro-benchmark, unless it 
+	came from a loaded profile. Devices that fail to run it are left at 0 GB/s.
+*/
+cl_int DeviceDatabase::Benchmark()
+{
+	for (DeviceInfo& eachDevice : _devices)
+	{
+		if (eachDevice.profile.copyGBs <= 0)
+		{
+			eachDevice.bandwidthGBs = MeasureCopyBandwidth(eachDevice);
+		}
+	}
+
+	return CL_SUCCESS;
+}
+
+/**
+	Runs the DeviceProfiler suite on every device, prints each profile and saves it to 
+	the given directory. The profiled copy bandwidth becomes the device's bandwidth. 
+	Returns the first error, after profiling every device it can.
+*/
+cl_int DeviceDatabase::Profile(const std::string& directory)
+{
+	cl_int firstError = CL_SUCCESS;
+
+	for (DeviceInfo& eachDevice : _devices)
+	{
+		cl_int result = DeviceProfiler::Measure(eachDevice, eachDevice.profile);
+		eachDevice.bandwidthGBs = eachDevice.profile.copyGBs;
+		DeviceProfiler::Print(std::cout, eachDevice.profile);
+
+		if (result != CL_SUCCESS)
+		{
+			std::cout << "Some benchmarks failed on " << eachDevice.name << " (" << ClError::GetName(result) << ").\n\n";
+			firstError = (firstError != CL_SUCCESS) ? firstError : result;
+		}
+
+		std::string path = DeviceProfiler::GetPath(directory, eachDevice);
+		if (!DeviceProfiler::Save(path, eachDevice.profile))
+		{
+			std::cout << "Failed to write " << path << ".\n\n";
+		}
+	}
+
+	return firstError;
+}
+
+/**
+	Loads the saved profile of every device that has one in the given directory, 
+	taking its bandwidth from the profile. Returns how many were loaded.
+*/
+size_t DeviceDatabase::LoadProfiles(const std::string& directory)
+{
+	size_t numLoaded = 0;
+
+	for (DeviceInfo& eachDevice : _devices)
+	{
+		if (DeviceProfiler::Load(DeviceProfiler::GetPath(directory, eachDevice), eachDevice, eachDevice.profile))
+		{
+			eachDevice.bandwidthGBs = eachDevice.profile.copyGBs;
+			numLoaded++;
+		}
+	}
+
+	return numLoaded;
+}
+
+/**
+	Scores every device with the given weights.
+*/
+void DeviceDatabase::Score(const DeviceScoreWeights& weights)
+{
+	for (DeviceInfo& eachDevice : _devices)
+	{
+		double compute = eachDevice.computeUnits * (eachDevice.clockMHz / 1000.0) * 
+			std::max<cl_uint>(eachDevice.nativeFloatWidth, 1);
+		double memoryGB = eachDevice.globalMemory / (1024.0 * 1024.0 * 1024.0);
+
+		eachDevice.score = 
+			weights.compute * compute + 
+			weights.memory * memoryGB + 
+			weights.hostUnifiedMemory * (eachDevice.hostUnifiedMemory ? 1.0 : 0.0) + 
+			weights.bandwidth * eachDevice.bandwidthGBs;
+	}
+}
+
+/**
+	Returns every discovered device.
+*/
+const std::vector<DeviceInfo>& DeviceDatabase::GetDevices() const
+{
+	return _devices;
+}
+
+/**
+	Returns the entry for the given device, or nullptr if it was not discovered.
+*/
+const DeviceInfo* DeviceDatabase::Find(cl_device_id device) const
+{
+	for (const DeviceInfo& eachDevice : _devices)
+	{
+		if (eachDevice.device == device)
+		{
+			return &eachDevice;
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+	Returns the device to use for work of the given type.
+	
+	If deviceOverride is set, the first device of the given type that it matches is 
+	returned. It may be an index into the database, "platform:device" indices, or part 
+	of a device, vendor or platform name. Otherwise the highest scoring device of the 
+	given type is returned. Returns nullptr if nothing matches.
+*/
+const DeviceInfo* DeviceDatabase::Select(cl_device_type type, const std::string& deviceOverride) const
+{
+	if (!deviceOverride.empty())
+	{
+		for (size_t i = 0; i < _devices.size(); i++)
+		{
+			if ((_devices[i].type & type) != 0 && Matches(_devices[i], i, deviceOverride))
+			{
+				return &_devices[i];
+			}
+		}
+
+		return nullptr;
+	}
+
+	return SelectOnPlatform(type, nullptr);
+}
+
+/**
+	Returns the highest scoring device of the given type on the given platform, or on 
+	any platform if platform is null. Returns nullptr if there is none.
+*/
+const DeviceInfo* DeviceDatabase::SelectOnPlatform(cl_device_type type, cl_platform_id platform) const
+{
+	const DeviceInfo* best = nullptr;
+
+	for (const DeviceInfo& eachDevice : _devices)
+	{
+		if ((eachDevice.type & type) == 0 || (platform && eachDevice.platform != platform))
+		{
+			continue;
+		}
+
+		if (!best || eachDevice.score > best->score)
+		{
+			best = &eachDevice;
+		}
+	}
+
+	return best;
+}
+
+/**
+	Prints a table of every device and its capabilities.
+*/
+void DeviceDatabase::Print(std::ostream& stream) const
+{
+	stream << "Detected the following devices:\n";
+
+	for (size_t i = 0; i < _devices.size(); i++)
+	{
+		const DeviceInfo& info = _devices[i];
+
+		stream << "\t[" << i << "] " << info.platformIndex << ":" << info.deviceIndex << " " << 
+			info.name << " (" << GetTypeName(info.type) << ") on " << info.platformName << "\n" <<
+			"\t\t" << info.computeUnits << " compute units at " << info.clockMHz << " MHz, " <<
+			"float vector width " << info.preferredFloatWidth << "/" << info.nativeFloatWidth << "\n" <<
+			"\t\t" << (info.globalMemory >> 20) << " MB global, " << 
+			(info.localMemory >> 10) << " KB local, " << 
+			(info.maxAllocation >> 20) << " MB max allocation, " << 
+			"max work-group " << info.maxWorkGroupSize << 
+			(info.hostUnifiedMemory ? ", host unified memory" : "") << "\n" <<
+			"\t\tScore " << std::fixed << std::setprecision(1) << info.score;
+
+		if (info.bandwidthGBs > 0)
+		{
+			stream << ", copy bandwidth " << info.bandwidthGBs << " GB/s";
+		}
+
+		if (info.profile.isMeasured)
+		{
+			stream << ", profiled at " << info.profile.GetPeakGFlops() << " GFLOP/s, " << 
+				info.profile.launchMicros << " us launch";
+		}
+
+		stream << std::defaultfloat << "\n";
+	}
+
+	stream << "\n";
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Returns a short name for a device type.
+*/
+std::string DeviceDatabase::GetTypeName(cl_device_type type)
+{
+	if (type & CL_DEVICE_TYPE_CPU)
+	{
+		return "CPU";
+	}
+
+	if (type & CL_DEVICE_TYPE_GPU)
+	{
+		return "GPU";
+	}
+
+	if (type & CL_DEVICE_TYPE_ACCELERATOR)
+	{
+		return "ACCELERATOR";
+	}
+
+	return "OTHER";
+}
+
+/**
+	Returns the device type named by GetTypeName, or 0 if the name is not one of them.
+*/
+cl_device_type DeviceDatabase::ParseType(const std::string& name)
+{
+	if (name == "CPU")
+	{
+		return CL_DEVICE_TYPE_CPU;
+	}
+
+	if (name == "GPU")
+	{
+		return CL_DEVICE_TYPE_GPU;
+	}
+
+	if (name == "ACCELERATOR")
+	{
+		return CL_DEVICE_TYPE_ACCELERATOR;
+	}
+
+	return 0;
+}
+
+/**
+	Returns a string property of a platform.
+*/
+std::string DeviceDatabase::GetPlatformString(cl_platform_id platform, cl_platform_info param)
+{
+	size_t size = 0;
+	clGetPlatformInfo(platform, param, 0, nullptr, &size);
+
+	std::string value(size, '\0');
+	clGetPlatformInfo(platform, param, size, &value[0], nullptr);
+
+	/* Drop the null terminator. */
+	return value.c_str();
+}
+
+/**
+	Returns a string property of a device.
+*/
+std::string DeviceDatabase::GetDeviceString(cl_device_id device, cl_device_info param)
+{
+	size_t size = 0;
+	clGetDeviceInfo(device, param, 0, nullptr, &size);
+
+	std::string value(size, '\0');
+	clGetDeviceInfo(device, param, size, &value[0], nullptr);
+
+	return value.c_str();
+}
+
+/**
+	Returns whether a device matches an override given as an index, as 
+	"platform:device" indices, or as part of its name, vendor or platform name.
+*/
+bool DeviceDatabase::Matches(const DeviceInfo& info, size_t index, const std::string& deviceOverride)
+{
+	bool isNumber = !deviceOverride.empty() && 
+		std::all_of(deviceOverride.begin(), deviceOverride.end(), [](char c) { return isdigit((unsigned char)c) != 0; });
+
+	if (isNumber)
+	{
+		return std::stoul(deviceOverride) == index;
+	}
+
+	size_t colon = deviceOverride.find(':');
+	if (colon != std::string::npos && colon > 0 && colon + 1 < deviceOverride.size() && 
+		isdigit((unsigned char)deviceOverride[0]) && isdigit((unsigned char)deviceOverride[colon + 1]))
+	{
+		return std::stoul(deviceOverride.substr(0, colon)) == info.platformIndex && 
+			std::stoul(deviceOverride.substr(colon + 1)) == info.deviceIndex;
+	}
+
+	auto toLower = [](std::string value)
+	{
+		std::transform(value.begin(), value.end(), value.begin(), [](char c) { return (char)tolower((unsigned char)c); });
+		return value;
+	};
+
+	std::string pattern = toLower(deviceOverride);
+	return toLower(info.name).find(pattern) != std::string::npos || 
+		toLower(info.vendor).find(pattern) != std::string::npos || 
+		toLower(info.platformName).find(pattern) != std::string::npos;
+}
+
+/**
+	Copies a buffer on the device a few times and returns the bandwidth achieved in 
+	GB/s, counting both the read and the write. Returns 0 if the benchmark cannot run.
+*/
+double DeviceDatabase::MeasureCopyBandwidth(const DeviceInfo& info)
+{
+	cl_int result = 0;
+	size_t bytes = (size_t)std::min<cl_ulong>(BENCHMARK_BYTES, info.maxAllocation);
+	size_t globalSize = bytes / sizeof(cl_float4);
+	double seconds = 0;
+
+	ClContext context(clCreateContext(0, 1, &info.device, NULL, NULL, &result));
+	if (result != CL_SUCCESS)
+	{
+		return 0;
+	}
+
+	ClCommandQueue commandQueue(clCreateCommandQueue(context, info.device, 0, &result));
+	ClProgram program;
+	ClKernel kernel;
+	ClMem source;
+	ClMem destination;
+
+	if (result == CL_SUCCESS)
+	{
+		program.Reset(clCreateProgramWithSource(context, 1, &COPY_KERNEL_SOURCE, NULL, &result));
+	}
+	if (result == CL_SUCCESS)
+	{
+		result = clBuildProgram(program, 1, &info.device, NULL, NULL, NULL);
+	}
+	if (result == CL_SUCCESS)
+	{
+		kernel.Reset(clCreateKernel(program, "copyPixels", &result));
+	}
+	if (result == CL_SUCCESS)
+	{
+		source.Reset(clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_HOST_NO_ACCESS, bytes, NULL, &result));
+	}
+	if (result == CL_SUCCESS)
+	{
+		destination.Reset(clCreateBuffer(context, CL_MEM_WRITE_ONLY | CL_MEM_HOST_NO_ACCESS, bytes, NULL, &result));
+	}
+	if (result == CL_SUCCESS)
+	{
+		result = clSetKernelArg(kernel, 0, sizeof(cl_mem), source.GetAddress());
+		result |= clSetKernelArg(kernel, 1, sizeof(cl_mem), destination.GetAddress());
+	}
+
+	/* One warm-up run, then time the rest. */
+	for (int run = 0; run <= BENCHMARK_RUNS && result == CL_SUCCESS; run++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		result = clEnqueueNDRangeKernel(commandQueue, kernel, 1, NULL, &globalSize, NULL, 0, NULL, NULL);
+		result |= clFinish(commandQueue);
+
+		if (run > 0)
+		{
+			seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+
+	if (result != CL_SUCCESS || seconds <= 0)
+	{
+		return 0;
+	}
+
+	return (2.0 * bytes * BENCHMARK_RUNS) / seconds / 1e9;
+}
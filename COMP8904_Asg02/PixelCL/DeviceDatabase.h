@@ -0,0 +1,124 @@
+/*===================================================================================*//**
+	DeviceDatabase
+	
+	Discovers every OpenCL device on every platform, records its capabilities and ranks 
+	the devices by a configurable score or a quick bandwidth micro-benchmark.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see DeviceDatabase
+	@see DeviceDatabase.cpp
+	
+*//*====================================================================================*/
+
+#ifndef DEVICE_DATABASE_H
+#define DEVICE_DATABASE_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <ostream>
+#include <string>
+#include <vector>
+#include <CL/cl.h>
+#include "DeviceProfile.h"
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	Capabilities of one OpenCL device.
+*/
+struct DeviceInfo
+{
+	public:
+		cl_platform_id platform;
+		cl_device_id device;
+		cl_device_type type;
+		size_t platformIndex;
+		size_t deviceIndex;
+		std::string platformName;
+		std::string name;
+		std::string vendor;
+		std::string version;
+		cl_uint computeUnits;
+		cl_uint clockMHz;
+		cl_ulong globalMemory;
+		cl_ulong localMemory;
+		cl_ulong maxAllocation;
+		cl_ulong constantMemory;
+		cl_uint baseAddressAlignBits;
+		size_t maxWorkGroupSize;
+		bool hostUnifiedMemory;
+		cl_uint preferredFloatWidth;
+		cl_uint nativeFloatWidth;
+		double bandwidthGBs;
+		double score;
+		DeviceProfile profile;
+};
+
+/**
+	Weights used to rank devices. The score is the weighted sum of
+	
+		compute units x clock in GHz x native float vector width, 
+		global memory in GB, 
+		1 if the device shares memory with the host, and 
+		the measured copy bandwidth in GB/s (0 unless the devices were benchmarked).
+*/
+struct DeviceScoreWeights
+{
+	public:
+		double compute = 1.0;
+		double memory = 0.0;
+		double hostUnifiedMemory = 0.0;
+		double bandwidth = 0.0;
+};
+
+/*========================================================================================
+	DeviceDatabase	
+========================================================================================*/
+/**
+	Capabilities of every device on every platform, with scoring and selection.
+	
+	@see DeviceDatabase.cpp
+*/
+class DeviceDatabase
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::vector<DeviceInfo> _devices;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		cl_int Discover();
+		cl_int Benchmark();
+		cl_int Profile(const std::string& directory);
+		size_t LoadProfiles(const std::string& directory);
+		void Score(const DeviceScoreWeights& weights);
+		const std::vector<DeviceInfo>& GetDevices() const;
+		const DeviceInfo* Find(cl_device_id device) const;
+		const DeviceInfo* Select(cl_device_type type, const std::string& deviceOverride) const;
+		const DeviceInfo* SelectOnPlatform(cl_device_type type, cl_platform_id platform) const;
+		void Print(std::ostream& stream) const;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static std::string GetTypeName(cl_device_type type);
+		static cl_device_type ParseType(const std::string& name);
+		static double MeasureCopyBandwidth(const DeviceInfo& info);
+
+    private:
+		static std::string GetPlatformString(cl_platform_id platform, cl_platform_info param);
+		static std::string GetDeviceString(cl_device_id device, cl_device_info param);
+		static bool Matches(const DeviceInfo& info, size_t index, const std::string& deviceOverride);
+};
+
+#endif
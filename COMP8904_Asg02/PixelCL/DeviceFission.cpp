@@ -0,0 +1,360 @@
+/*===================================================================================*//**
+	DeviceFission
+	
+	Splits a CPU device into NUMA or cache affinity domains so that each domain has its 
+	own queue and works on its own pixel range from host memory local to it.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see DeviceFission
+	@see DeviceFission.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "DeviceFission.h"
+#include "HostTopology.h"
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates an unpartitioned fission.
+*/
+DeviceFission::DeviceFission() : 
+	_parentDevice(nullptr), 
+	_ownsSubDevices(false)
+{
+}
+
+/**
+	Releases the sub-devices, queues, kernels, program and context.
+*/
+DeviceFission::~DeviceFission()
+{
+	Release();
+}
+
+/**
+	Partitions a device by the given affinity domain, such as 
+	CL_DEVICE_AFFINITY_DOMAIN_NUMA or CL_DEVICE_AFFINITY_DOMAIN_L3_CACHE.
+	
+	If the device cannot be partitioned that way, the whole device is used as a single 
+	domain so callers do not need a separate path.
+*/
+cl_int DeviceFission::Partition(cl_device_id device, cl_device_affinity_domain affinityDomain)
+{
+	Release();
+	_parentDevice = device;
+
+	cl_device_affinity_domain supported = 0;
+	clGetDeviceInfo(device, CL_DEVICE_PARTITION_AFFINITY_DOMAIN, sizeof(supported), &supported, nullptr);
+
+	cl_uint numSubDevices = 0;
+	cl_int result = CL_INVALID_VALUE;
+	const cl_device_partition_property properties[] = { 
+		CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN, (cl_device_partition_property)affinityDomain, 0 };
+
+	if (supported & affinityDomain)
+	{
+		result = clCreateSubDevices(device, properties, 0, nullptr, &numSubDevices);
+	}
+
+	std::vector<cl_device_id> devices;
+	if (result == CL_SUCCESS && numSubDevices > 1)
+	{
+		devices.resize(numSubDevices);
+		result = clCreateSubDevices(device, properties, numSubDevices, devices.data(), nullptr);
+		_ownsSubDevices = (result == CL_SUCCESS);
+	}
+
+	if (!_ownsSubDevices)
+	{
+		/* A single domain gains nothing from sub-devices, so use the parent directly. */
+		for (cl_device_id eachDevice : devices)
+		{
+			if (eachDevice)
+			{
+				clReleaseDevice(eachDevice);
+			}
+		}
+		devices.assign(1, device);
+	}
+
+	/* OpenCL does not say which CPUs a sub-device covers, so only NUMA domains are given 
+	a node. L3 domains can share a node or span several, and are left unplaced. */
+	bool isNuma = _ownsSubDevices && affinityDomain == CL_DEVICE_AFFINITY_DOMAIN_NUMA;
+	int numNodes = HostTopology::GetNumaNodeCount();
+	for (size_t i = 0; i < devices.size(); i++)
+	{
+		FissionDomain domain = FissionDomain();
+		domain.device = devices[i];
+		domain.node = isNuma ? (int)i % numNodes : -1;
+		_domains.push_back(std::move(domain));
+	}
+
+	return CL_SUCCESS;
+}
+
+/**
+	Creates a context over the domains, then a queue and an instance of the named kernel 
+	for each domain.
+*/
+cl_int DeviceFission::Build(const std::string& source, const char* kernelName)
+{
+	cl_int result = 0;
+	std::vector<cl_device_id> devices;
+	for (const FissionDomain& eachDomain : _domains)
+	{
+		devices.push_back(eachDomain.device);
+	}
+
+	_context.Reset(clCreateContext(0, (cl_uint)devices.size(), devices.data(), NULL, NULL, &result));
+	if (result != CL_SUCCESS)
+	{
+		return result;
+	}
+
+	const char* sourceAsChar = source.c_str();
+	_program.Reset(clCreateProgramWithSource(_context, 1, &sourceAsChar, NULL, &result));
+	if (result != CL_SUCCESS)
+	{
+		return result;
+	}
+
+	result = clBuildProgram(_program, (cl_uint)devices.size(), devices.data(), NULL, NULL, NULL);
+	if (result != CL_SUCCESS)
+	{
+		return result;
+	}
+
+	for (FissionDomain& eachDomain : _domains)
+	{
+		eachDomain.commandQueue.Reset(clCreateCommandQueue(_context, eachDomain.device, 0, &result));
+		if (result != CL_SUCCESS)
+		{
+			return result;
+		}
+
+		eachDomain.kernel.Reset(clCreateKernel(_program, kernelName, &result));
+		if (result != CL_SUCCESS)
+		{
+			return result;
+		}
+	}
+
+	return CL_SUCCESS;
+}
+
+/**
+	Splits the pixels into one contiguous range per domain. Range boundaries are 
+	rounded to the device's base address alignment so each range can be a sub-buffer.
+*/
+void DeviceFission::AssignRanges(size_t numPixels)
+{
+	cl_uint alignBits = 0;
+	clGetDeviceInfo(_parentDevice, CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(alignBits), &alignBits, nullptr);
+	size_t alignPixels = std::max<size_t>(1, (alignBits / 8) / sizeof(cl_float4));
+
+	size_t share = (numPixels + _domains.size() - 1) / _domains.size();
+	share = ((share + alignPixels - 1) / alignPixels) * alignPixels;
+
+	for (size_t i = 0; i < _domains.size(); i++)
+	{
+		_domains[i].firstPixel = std::min(i * share, numPixels);
+		_domains[i].numPixels = std::min(share, numPixels - _domains[i].firstPixel);
+	}
+}
+
+/**
+	Runs the initializer for each domain on a thread pinned to that domain's NUMA node. 
+	The pages each domain touches first are then allocated on its own node. Domains 
+	with no known node are initialized on an unpinned thread.
+*/
+void DeviceFission::FirstTouch(std::function<void(const FissionDomain& domain)> initialize) const
+{
+	std::vector<std::thread> threads;
+
+	for (const FissionDomain& eachDomain : _domains)
+	{
+		threads.push_back(std::thread([&initialize, &eachDomain]()
+		{
+			if (eachDomain.node >= 0)
+			{
+				HostTopology::PinCurrentThreadToNode(eachDomain.node);
+			}
+
+			initialize(eachDomain);
+		}));
+	}
+
+	for (std::thread& eachThread : threads)
+	{
+		eachThread.join();
+	}
+}
+
+/**
+	Runs each domain's kernel over its own range of the host arrays and waits for all 
+	of them. The arrays are wrapped with CL_MEM_USE_HOST_PTR, so on a CPU device the 
+	kernels work straight out of the first-touched pages. Each domain gets its own 
+	sub-buffers.
+*/
+cl_int DeviceFission::Execute(cl_float4* startPixels, cl_float4* resultPixels, size_t numPixels, size_t localSize)
+{
+	cl_int result = 0;
+	size_t bufferSize = sizeof(cl_float4) * numPixels;
+	std::vector<ClMem> buffers;
+
+	cl_mem clStartPixels = clCreateBuffer(_context, CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR, bufferSize, startPixels, &result);
+	if (result != CL_SUCCESS)
+	{
+		return result;
+	}
+	buffers.emplace_back(clStartPixels);
+
+	cl_mem clResultPixels = clCreateBuffer(_context, CL_MEM_WRITE_ONLY | CL_MEM_USE_HOST_PTR, bufferSize, resultPixels, &result);
+	if (result == CL_SUCCESS)
+	{
+		buffers.emplace_back(clResultPixels);
+	}
+
+	/* Launch every domain before waiting on any of them. */
+	std::vector<cl_mem> outputs(_domains.size(), nullptr);
+	for (size_t i = 0; i < _domains.size() && result == CL_SUCCESS; i++)
+	{
+		FissionDomain& domain = _domains[i];
+		if (domain.numPixels == 0)
+		{
+			continue;
+		}
+
+		cl_buffer_region region = { sizeof(cl_float4) * domain.firstPixel, sizeof(cl_float4) * domain.numPixels };
+		cl_mem input = clCreateSubBuffer(clStartPixels, CL_MEM_READ_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &region, &result);
+		if (result != CL_SUCCESS)
+		{
+			break;
+		}
+		buffers.emplace_back(input);
+
+		outputs[i] = clCreateSubBuffer(clResultPixels, CL_MEM_WRITE_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &region, &result);
+		if (result != CL_SUCCESS)
+		{
+			break;
+		}
+		buffers.emplace_back(outputs[i]);
+
+		result = clSetKernelArg(domain.kernel, 0, sizeof(cl_mem), &input);
+		result |= clSetKernelArg(domain.kernel, 1, sizeof(cl_mem), &outputs[i]);
+		if (result != CL_SUCCESS)
+		{
+			break;
+		}
+
+		size_t globalSize = domain.numPixels;
+		const size_t* localSizePtr = (localSize != 0 && globalSize % localSize == 0) ? &localSize : NULL;
+		result = clEnqueueNDRangeKernel(domain.commandQueue, domain.kernel, 1, NULL, &globalSize, localSizePtr, 0, NULL, NULL);
+		clFlush(domain.commandQueue);
+	}
+
+	/* Map each output range so its results are guaranteed visible in host memory. */
+	for (size_t i = 0; i < _domains.size(); i++)
+	{
+		if (!outputs[i])
+		{
+			continue;
+		}
+
+		cl_int mapResult = 0;
+		void* mapped = clEnqueueMapBuffer(
+			_domains[i].commandQueue, outputs[i], 
+			CL_TRUE, CL_MAP_READ, 
+			0, sizeof(cl_float4) * _domains[i].numPixels, 
+			0, NULL, NULL, 
+			&mapResult);
+
+		if (mapResult == CL_SUCCESS)
+		{
+			clEnqueueUnmapMemObject(_domains[i].commandQueue, outputs[i], mapped, 0, NULL, NULL);
+		}
+		else if (result == CL_SUCCESS)
+		{
+			result = mapResult;
+		}
+
+		clFinish(_domains[i].commandQueue);
+	}
+
+	/* Sub-buffers go before their parents. */
+	while (!buffers.empty())
+	{
+		buffers.pop_back();
+	}
+
+	return result;
+}
+
+/**
+	Returns the domains and their assigned ranges.
+*/
+const std::vector<FissionDomain>& DeviceFission::GetDomains() const
+{
+	return _domains;
+}
+
+/**
+	Returns whether the device was actually split into sub-devices.
+*/
+bool DeviceFission::IsPartitioned() const
+{
+	return _ownsSubDevices;
+}
+
+/**
+	Releases everything created by Partition and Build.
+*/
+void DeviceFission::Release()
+{
+	for (FissionDomain& eachDomain : _domains)
+	{
+		eachDomain.kernel.Reset();
+		eachDomain.commandQueue.Reset();
+		if (_ownsSubDevices)
+		{
+			clReleaseDevice(eachDomain.device);
+		}
+	}
+
+	_domains.clear();
+	_ownsSubDevices = false;
+	_program.Reset();
+	_context.Reset();
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Returns the affinity domain named by "numa" or "l3", or 0 for anything else.
+*/
+cl_device_affinity_domain DeviceFission::ParseAffinityDomain(const std::string& name)
+{
+	if (name == "numa")
+	{
+		return CL_DEVICE_AFFINITY_DOMAIN_NUMA;
+	}
+
+	if (name == "l3")
+	{
+		return CL_DEVICE_AFFINITY_DOMAIN_L3_CACHE;
+	}
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+/*===================================================================================*//**
+	DeviceFission
+	
+	Splits a CPU device into NUMA or cache affinity domains so that each domain has its 
+	own queue and works on its own pixel range from host memory local to it.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see DeviceFission
+	@see DeviceFission.cpp
+	
+*//*====================================================================================*/
+
+#ifndef DEVICE_FISSION_H
+#define DEVICE_FISSION_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include <CL/cl.h>
+#include "ClHandle.h"
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	One affinity domain of a partitioned device and the pixels it is responsible for.
+*/
+struct FissionDomain
+{
+	public:
+		cl_device_id device;
+		ClCommandQueue commandQueue;
+		ClKernel kernel;
+		int node;
+		size_t firstPixel;
+		size_t numPixels;
+};
+
+/*========================================================================================
+	DeviceFission	
+========================================================================================*/
+/**
+	A device partitioned by affinity domain, with a queue and kernel per domain.
+	
+	When split by NUMA domain, domain i is assumed to sit on NUMA node i (modulo the 
+	node count). This is how the CPU runtimes we use order their NUMA sub-devices. Other 
+	domains have a node of -1, since OpenCL does not say which CPUs they cover.
+	
+	@see DeviceFission.cpp
+*/
+class DeviceFission
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		cl_device_id _parentDevice;
+		bool _ownsSubDevices;
+		ClContext _context;
+		ClProgram _program;
+		std::vector<FissionDomain> _domains;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		DeviceFission();
+		~DeviceFission();
+		DeviceFission(const DeviceFission&) = delete;
+		DeviceFission& operator=(const DeviceFission&) = delete;
+
+		cl_int Partition(cl_device_id device, cl_device_affinity_domain affinityDomain);
+		cl_int Build(const std::string& source, const char* kernelName);
+		void AssignRanges(size_t numPixels);
+		void FirstTouch(std::function<void(const FissionDomain& domain)> initialize) const;
+		cl_int Execute(cl_float4* startPixels, cl_float4* resultPixels, size_t numPixels, size_t localSize);
+		const std::vector<FissionDomain>& GetDomains() const;
+		bool IsPartitioned() const;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static cl_device_affinity_domain ParseAffinityDomain(const std::string& name);
+
+    private:
+		void Release();
+};
+
+#endif
@@ -0,0 +1,496 @@
+/*===================================================================================*//**
+	DeviceProfile
+	
+	Measured transfer bandwidths, latencies and compute peaks of an OpenCL device, saved 
+	to a profile file per device.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see DeviceProfile
+	@see DeviceProfiler
+	@see DeviceProfile.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "DeviceProfile.h"
+#include "ClHandle.h"
+#include "DeviceDatabase.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <vector>
+
+/*========================================================================================
+	Constants
+========================================================================================*/
+/** Kernels for the latency and compute benchmarks. FLOATN is set when building. Each 
+	work-item does 64 x 16 multiply-adds per lane. */
+const char* PROFILE_KERNEL_SOURCE =
+	"__kernel void empty()\n"
+	"{\n"
+	"}\n"
+	"\n"
+	"#define MAD_4(x, y) x = mad(y, x, y); y = mad(x, y, x); x = mad(y, x, y); y = mad(x, y, x);\n"
+	"#define MAD_16(x, y) MAD_4(x, y) MAD_4(x, y) MAD_4(x, y) MAD_4(x, y)\n"
+	"\n"
+	"__kernel void computePeak(__global FLOATN* output, float seed)\n"
+	"{\n"
+	"	FLOATN x = (FLOATN)(seed);\n"
+	"	FLOATN y = (FLOATN)((float)get_local_id(0));\n"
+	"	for (int i = 0; i < 64; i++)\n"
+	"	{\n"
+	"		MAD_16(x, y)\n"
+	"	}\n"
+	"	output[get_global_id(0)] = x + y;\n"
+	"}\n";
+
+/** FLOPs each work-item of computePeak does per vector lane. */
+const double COMPUTE_FLOPS_PER_LANE = 64 * 16 * 2;
+
+/** Lanes of computePeak launched per compute unit, split across work-items by width. */
+const size_t COMPUTE_LANES_PER_UNIT = 64 * 1024;
+
+/** Bytes moved by each run of the transfer benchmarks. */
+const size_t TRANSFER_BYTES = 32 * 1024 * 1024;
+
+/** Timed runs of the transfer and compute benchmarks, after one warm-up run. */
+const int PROFILE_RUNS = 3;
+
+/** Round trips averaged by the latency benchmarks. */
+const int LATENCY_RUNS = 100;
+
+/*----------------------------------------------------------------------------------------
+	DeviceProfile
+----------------------------------------------------------------------------------------*/
+/**
+	Returns the higher of the float and vector compute peaks.
+*/
+double DeviceProfile::GetPeakGFlops() const
+{
+	return std::max(scalarGFlops, vectorGFlops);
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Runs the suite on a device in a context of its own. Benchmarks that fail are left 
+	at 0, and the first error is returned.
+*/
+cl_int DeviceProfiler::Measure(const DeviceInfo& info, DeviceProfile& profile)
+{
+	profile = DeviceProfile();
+	profile.deviceName = info.name;
+	profile.deviceVersion = info.version;
+
+	cl_int result = 0;
+	ClContext context(clCreateContext(0, 1, &info.device, NULL, NULL, &result));
+
+	if (result != CL_SUCCESS)
+	{
+		return result;
+	}
+
+	ClCommandQueue commandQueue(clCreateCommandQueue(context, info.device, 0, &result));
+
+	if (result != CL_SUCCESS)
+	{
+		return result;
+	}
+
+	/* Transfers between pageable host memory, pinned host memory and a device buffer. */
+	size_t bytes = (size_t)std::min<cl_ulong>(TRANSFER_BYTES, info.maxAllocation);
+	std::vector<char> pageable(bytes, 1);
+	ClMem deviceBuffer(clCreateBuffer(context, CL_MEM_READ_WRITE, bytes, NULL, &result));
+	cl_int firstError = result;
+
+	if (result == CL_SUCCESS)
+	{
+		result = MeasureTransfers(commandQueue, deviceBuffer, pageable.data(), bytes, profile.writePageableGBs, profile.readPageableGBs);
+		firstError = (firstError != CL_SUCCESS) ? firstError : result;
+
+		ClMem pinnedBuffer(clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bytes, NULL, &result));
+		void* pinned = nullptr;
+
+		if (result == CL_SUCCESS)
+		{
+			pinned = clEnqueueMapBuffer(commandQueue, pinnedBuffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, bytes, 0, NULL, NULL, &result);
+		}
+		if (result == CL_SUCCESS)
+		{
+			result = MeasureTransfers(commandQueue, deviceBuffer, pinned, bytes, profile.writePinnedGBs, profile.readPinnedGBs);
+			clEnqueueUnmapMemObject(commandQueue, pinnedBuffer, pinned, 0, NULL, NULL);
+			clFinish(commandQueue);
+		}
+		firstError = (firstError != CL_SUCCESS) ? firstError : result;
+
+		result = MeasureMapped(commandQueue, deviceBuffer, pageable.data(), bytes, profile);
+		firstError = (firstError != CL_SUCCESS) ? firstError : result;
+	}
+
+	result = MeasureLatency(context, commandQueue, info.device, profile);
+	firstError = (firstError != CL_SUCCESS) ? firstError : result;
+
+	profile.copyGBs = DeviceDatabase::MeasureCopyBandwidth(info);
+
+	/* Float, then the preferred vector width rounded to an OpenCL vector size. */
+	profile.vectorWidth = 4;
+	while (profile.vectorWidth < info.preferredFloatWidth && profile.vectorWidth < 16)
+	{
+		profile.vectorWidth *= 2;
+	}
+
+	result = MeasureCompute(context, commandQueue, info, 1, profile.scalarGFlops);
+	firstError = (firstError != CL_SUCCESS) ? firstError : result;
+	result = MeasureCompute(context, commandQueue, info, profile.vectorWidth, profile.vectorGFlops);
+	firstError = (firstError != CL_SUCCESS) ? firstError : result;
+
+	profile.isMeasured = true;
+	return firstError;
+}
+
+/**
+	Loads a profile saved by Save. Returns false if the file cannot be read or was 
+	measured on a different device or driver version.
+*/
+bool DeviceProfiler::Load(const std::string& path, const DeviceInfo& info, DeviceProfile& profile)
+{
+	std::ifstream file(path);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	const char* whitespace = " \t\r";
+	std::map<std::string, std::string> values;
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		size_t first = line.find_first_not_of(whitespace);
+		size_t equals = line.find('=');
+
+		if (first == std::string::npos || line[first] == '#' || equals == std::string::npos)
+		{
+			continue;
+		}
+
+		std::string name = line.substr(first, equals - first);
+		std::string value = line.substr(equals + 1);
+		name.erase(name.find_last_not_of(whitespace) + 1);
+		value.erase(0, value.find_first_not_of(whitespace));
+		value.erase(value.find_last_not_of(whitespace) + 1);
+		values[name] = value;
+	}
+
+	if (values["device"] != info.name || values["device-version"] != info.version)
+	{
+		return false;
+	}
+
+	auto getNumber = [&values](const char* name) { return std::atof(values[name].c_str()); };
+
+	profile = DeviceProfile();
+	profile.isMeasured = true;
+	profile.deviceName = info.name;
+	profile.deviceVersion = info.version;
+	profile.writePageableGBs = getNumber("write-pageable-gbs");
+	profile.readPageableGBs = getNumber("read-pageable-gbs");
+	profile.writePinnedGBs = getNumber("write-pinned-gbs");
+	profile.readPinnedGBs = getNumber("read-pinned-gbs");
+	profile.writeMappedGBs = getNumber("write-mapped-gbs");
+	profile.readMappedGBs = getNumber("read-mapped-gbs");
+	profile.mapMicros = getNumber("map-us");
+	profile.launchMicros = getNumber("launch-us");
+	profile.finishMicros = getNumber("finish-us");
+	profile.copyGBs = getNumber("copy-gbs");
+	profile.scalarGFlops = getNumber("float-gflops");
+	profile.vectorGFlops = getNumber("vector-gflops");
+	profile.vectorWidth = (cl_uint)getNumber("vector-width");
+	return true;
+}
+
+/**
+	Saves a profile as "name = value" lines. Returns false if it could not be written.
+*/
+bool DeviceProfiler::Save(const std::string& path, const DeviceProfile& profile)
+{
+	std::ofstream file(path);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file << "# Written by DeviceProfiler. Delete to measure again.\n" << 
+		"device = " << profile.deviceName << "\n" << 
+		"device-version = " << profile.deviceVersion << "\n" << 
+		"write-pageable-gbs = " << profile.writePageableGBs << "\n" << 
+		"read-pageable-gbs = " << profile.readPageableGBs << "\n" << 
+		"write-pinned-gbs = " << profile.writePinnedGBs << "\n" << 
+		"read-pinned-gbs = " << profile.readPinnedGBs << "\n" << 
+		"write-mapped-gbs = " << profile.writeMappedGBs << "\n" << 
+		"read-mapped-gbs = " << profile.readMappedGBs << "\n" << 
+		"map-us = " << profile.mapMicros << "\n" << 
+		"launch-us = " << profile.launchMicros << "\n" << 
+		"finish-us = " << profile.finishMicros << "\n" << 
+		"copy-gbs = " << profile.copyGBs << "\n" << 
+		"float-gflops = " << profile.scalarGFlops << "\n" << 
+		"vector-gflops = " << profile.vectorGFlops << "\n" << 
+		"vector-width = " << profile.vectorWidth << "\n";
+
+	return (bool)file;
+}
+
+/**
+	Returns the path of a device's profile in the given directory, named after its 
+	platform and device.
+*/
+std::string DeviceProfiler::GetPath(const std::string& directory, const DeviceInfo& info)
+{
+	std::string fileName;
+
+	for (char eachChar : info.platformName + "-" + info.name)
+	{
+		if (isalnum((unsigned char)eachChar))
+		{
+			fileName += (char)tolower((unsigned char)eachChar);
+		}
+		else if (!fileName.empty() && fileName.back() != '-')
+		{
+			fileName += '-';
+		}
+	}
+
+	while (!fileName.empty() && fileName.back() == '-')
+	{
+		fileName.pop_back();
+	}
+
+	return (directory.empty() ? std::string(".") : directory) + "/" + fileName + ".profile";
+}
+
+/**
+	Prints a profile.
+*/
+void DeviceProfiler::Print(std::ostream& stream, const DeviceProfile& profile)
+{
+	std::ios_base::fmtflags flags = stream.flags();
+	std::streamsize precision = stream.precision();
+
+	stream << std::fixed << std::setprecision(1) << 
+		"Profile of " << profile.deviceName << ":\n" << 
+		"\tHost to device: " << profile.writePageableGBs << " GB/s pageable, " << 
+		profile.writePinnedGBs << " GB/s pinned, " << profile.writeMappedGBs << " GB/s mapped\n" << 
+		"\tDevice to host: " << profile.readPageableGBs << " GB/s pageable, " << 
+		profile.readPinnedGBs << " GB/s pinned, " << profile.readMappedGBs << " GB/s mapped\n" << 
+		"\tMap and unmap: " << profile.mapMicros << " us\n" << 
+		"\tEmpty kernel launch: " << profile.launchMicros << " us, clFinish round trip: " << profile.finishMicros << " us\n" << 
+		"\tDevice copy: " << profile.copyGBs << " GB/s\n" << 
+		"\tCompute: " << profile.scalarGFlops << " GFLOP/s float, " << 
+		profile.vectorGFlops << " GFLOP/s float" << profile.vectorWidth << "\n\n";
+
+	stream.flags(flags);
+	stream.precision(precision);
+}
+
+/**
+	Times blocking writes from and reads into host memory, keeping the best of each.
+*/
+cl_int DeviceProfiler::MeasureTransfers(
+	cl_command_queue commandQueue, cl_mem buffer, 
+	void* host, size_t bytes, 
+	double& writeGBs, double& readGBs)
+{
+	cl_int result = CL_SUCCESS;
+
+	for (int run = 0; run <= PROFILE_RUNS && result == CL_SUCCESS; run++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		result = clEnqueueWriteBuffer(commandQueue, buffer, CL_TRUE, 0, bytes, host, 0, NULL, NULL);
+		double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		result |= clEnqueueReadBuffer(commandQueue, buffer, CL_TRUE, 0, bytes, host, 0, NULL, NULL);
+		double readSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (run > 0 && result == CL_SUCCESS)
+		{
+			writeGBs = std::max(writeGBs, bytes / writeSeconds / 1e9);
+			readGBs = std::max(readGBs, bytes / readSeconds / 1e9);
+		}
+	}
+
+	return result;
+}
+
+/**
+	Times writing and reading a device buffer by mapping it and copying to or from host 
+	memory, and the cost of a map and unmap on their own.
+*/
+cl_int DeviceProfiler::MeasureMapped(
+	cl_command_queue commandQueue, cl_mem buffer, 
+	void* host, size_t bytes, 
+	DeviceProfile& profile)
+{
+	cl_int result = CL_SUCCESS;
+
+	for (int run = 0; run <= PROFILE_RUNS && result == CL_SUCCESS; run++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		void* mapped = clEnqueueMapBuffer(commandQueue, buffer, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, 0, bytes, 0, NULL, NULL, &result);
+		if (result != CL_SUCCESS)
+		{
+			break;
+		}
+		std::memcpy(mapped, host, bytes);
+		result = clEnqueueUnmapMemObject(commandQueue, buffer, mapped, 0, NULL, NULL);
+		result |= clFinish(commandQueue);
+		double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		mapped = clEnqueueMapBuffer(commandQueue, buffer, CL_TRUE, CL_MAP_READ, 0, bytes, 0, NULL, NULL, &result);
+		if (result != CL_SUCCESS)
+		{
+			break;
+		}
+		std::memcpy(host, mapped, bytes);
+		result = clEnqueueUnmapMemObject(commandQueue, buffer, mapped, 0, NULL, NULL);
+		result |= clFinish(commandQueue);
+		double readSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		/* The same read mapping again, without touching the memory. */
+		start = std::chrono::steady_clock::now();
+		mapped = clEnqueueMapBuffer(commandQueue, buffer, CL_TRUE, CL_MAP_READ, 0, bytes, 0, NULL, NULL, &result);
+		if (result != CL_SUCCESS)
+		{
+			break;
+		}
+		result = clEnqueueUnmapMemObject(commandQueue, buffer, mapped, 0, NULL, NULL);
+		result |= clFinish(commandQueue);
+		double mapMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+		if (run > 0 && result == CL_SUCCESS)
+		{
+			profile.writeMappedGBs = std::max(profile.writeMappedGBs, bytes / writeSeconds / 1e9);
+			profile.readMappedGBs = std::max(profile.readMappedGBs, bytes / readSeconds / 1e9);
+			profile.mapMicros = (run == 1) ? mapMicros : std::min(profile.mapMicros, mapMicros);
+		}
+	}
+
+	return result;
+}
+
+/**
+	Times the round trip of an empty kernel launch and of clFinish on an empty queue, 
+	averaged over LATENCY_RUNS.
+*/
+cl_int DeviceProfiler::MeasureLatency(cl_context context, cl_command_queue commandQueue, cl_device_id device, DeviceProfile& profile)
+{
+	cl_int result = 0;
+	size_t globalSize = 1;
+	ClProgram program(clCreateProgramWithSource(context, 1, &PROFILE_KERNEL_SOURCE, NULL, &result));
+	ClKernel kernel;
+
+	if (result == CL_SUCCESS)
+	{
+		result = clBuildProgram(program, 1, &device, "-DFLOATN=float", NULL, NULL);
+	}
+	if (result == CL_SUCCESS)
+	{
+		kernel.Reset(clCreateKernel(program, "empty", &result));
+	}
+
+	/* One warm-up launch, then the timed ones. */
+	if (result == CL_SUCCESS)
+	{
+		result = clEnqueueNDRangeKernel(commandQueue, kernel, 1, NULL, &globalSize, NULL, 0, NULL, NULL);
+		result |= clFinish(commandQueue);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (int run = 0; run < LATENCY_RUNS && result == CL_SUCCESS; run++)
+	{
+		result = clEnqueueNDRangeKernel(commandQueue, kernel, 1, NULL, &globalSize, NULL, 0, NULL, NULL);
+		result |= clFinish(commandQueue);
+	}
+	double launchMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	for (int run = 0; run < LATENCY_RUNS && result == CL_SUCCESS; run++)
+	{
+		result = clFinish(commandQueue);
+	}
+	double finishMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+	if (result == CL_SUCCESS)
+	{
+		profile.launchMicros = launchMicros / LATENCY_RUNS;
+		profile.finishMicros = finishMicros / LATENCY_RUNS;
+	}
+
+	return result;
+}
+
+/**
+	Times chains of dependent multiply-adds at the given vector width and returns the 
+	best rate in GFLOP/s.
+*/
+cl_int DeviceProfiler::MeasureCompute(
+	cl_context context, cl_command_queue commandQueue, 
+	const DeviceInfo& info, cl_uint width, 
+	double& gflops)
+{
+	cl_int result = 0;
+	size_t globalSize = std::max<cl_uint>(info.computeUnits, 1) * COMPUTE_LANES_PER_UNIT / width;
+	std::string options = "-DFLOATN=float" + (width > 1 ? std::to_string(width) : std::string());
+	cl_float seed = 1.3f;
+
+	ClProgram program(clCreateProgramWithSource(context, 1, &PROFILE_KERNEL_SOURCE, NULL, &result));
+	ClKernel kernel;
+	ClMem output;
+
+	if (result == CL_SUCCESS)
+	{
+		result = clBuildProgram(program, 1, &info.device, options.c_str(), NULL, NULL);
+	}
+	if (result == CL_SUCCESS)
+	{
+		kernel.Reset(clCreateKernel(program, "computePeak", &result));
+	}
+	if (result == CL_SUCCESS)
+	{
+		output.Reset(clCreateBuffer(context, CL_MEM_WRITE_ONLY | CL_MEM_HOST_NO_ACCESS, globalSize * width * sizeof(cl_float), NULL, &result));
+	}
+	if (result == CL_SUCCESS)
+	{
+		result = clSetKernelArg(kernel, 0, sizeof(cl_mem), output.GetAddress());
+		result |= clSetKernelArg(kernel, 1, sizeof(cl_float), &seed);
+	}
+
+	for (int run = 0; run <= PROFILE_RUNS && result == CL_SUCCESS; run++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		result = clEnqueueNDRangeKernel(commandQueue, kernel, 1, NULL, &globalSize, NULL, 0, NULL, NULL);
+		result |= clFinish(commandQueue);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (run > 0 && result == CL_SUCCESS)
+		{
+			gflops = std::max(gflops, globalSize * width * COMPUTE_FLOPS_PER_LANE / seconds / 1e9);
+		}
+	}
+
+	return result;
+}
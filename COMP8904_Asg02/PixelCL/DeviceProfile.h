@@ -0,0 +1,106 @@
+/*===================================================================================*//**
+	DeviceProfile
+	
+	Measured transfer bandwidths, latencies and compute peaks of an OpenCL device, saved 
+	to a profile file per device.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see DeviceProfile
+	@see DeviceProfiler
+	@see DeviceProfile.cpp
+	
+*//*====================================================================================*/
+
+#ifndef DEVICE_PROFILE_H
+#define DEVICE_PROFILE_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <ostream>
+#include <string>
+#include <CL/cl.h>
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+struct DeviceInfo;
+
+/**
+	What DeviceProfiler measured on one device. Bandwidths are in GB/s, latencies in 
+	microseconds and compute peaks in GFLOP/s. A value of 0 was not measured.
+*/
+struct DeviceProfile
+{
+	public:
+		bool isMeasured;
+		std::string deviceName;
+		std::string deviceVersion;
+		double writePageableGBs;
+		double readPageableGBs;
+		double writePinnedGBs;
+		double readPinnedGBs;
+		double writeMappedGBs;
+		double readMappedGBs;
+		double mapMicros;
+		double launchMicros;
+		double finishMicros;
+		double copyGBs;
+		double scalarGFlops;
+		double vectorGFlops;
+		cl_uint vectorWidth;
+
+		double GetPeakGFlops() const;
+};
+
+/*========================================================================================
+	DeviceProfiler
+========================================================================================*/
+/**
+	Static class running a clpeak-style suite of micro-benchmarks on a device.
+	
+	The suite measures host to device and device to host bandwidth from pageable 
+	memory, from pinned memory (a CL_MEM_ALLOC_HOST_PTR buffer kept mapped) and by 
+	mapping the device buffer, the cost of a map and unmap, the round trip of an empty 
+	kernel and of clFinish on an empty queue, on-device copy bandwidth, and the 
+	multiply-add peak in float and the device's preferred float vector width. Each 
+	figure is the best of a few runs after a warm-up.
+	
+	Profiles are saved as "name = value" lines in the config file format, one file per 
+	device, so later runs can load them instead of measuring again. A profile is only 
+	loaded for the device and driver version it was measured on.
+	
+	@see DeviceProfile.cpp
+*/
+class DeviceProfiler
+{
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static cl_int Measure(const DeviceInfo& info, DeviceProfile& profile);
+		static bool Load(const std::string& path, const DeviceInfo& info, DeviceProfile& profile);
+		static bool Save(const std::string& path, const DeviceProfile& profile);
+		static std::string GetPath(const std::string& directory, const DeviceInfo& info);
+		static void Print(std::ostream& stream, const DeviceProfile& profile);
+
+    private:
+		static cl_int MeasureTransfers(
+			cl_command_queue commandQueue, cl_mem buffer, 
+			void* host, size_t bytes, 
+			double& writeGBs, double& readGBs);
+		static cl_int MeasureMapped(
+			cl_command_queue commandQueue, cl_mem buffer, 
+			void* host, size_t bytes, 
+			DeviceProfile& profile);
+		static cl_int MeasureLatency(cl_context context, cl_command_queue commandQueue, cl_device_id device, DeviceProfile& profile);
+		static cl_int MeasureCompute(
+			cl_context context, cl_command_queue commandQueue, 
+			const DeviceInfo& info, cl_uint width, 
+			double& gflops);
+};
+
+#endif
@@ -0,0 +1,198 @@
+/*===================================================================================*//**
+	HostTopology
+	
+	Static class for querying the host's NUMA layout and caches, and pinning threads to 
+	nodes.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see HostTopology
+	@see HostTopology.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "HostTopology.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+	#define NOMINMAX
+	#include <windows.h>
+#elif defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Returns the number of NUMA nodes on the host, which is 1 on single-socket machines 
+	and wherever the layout cannot be read.
+*/
+int HostTopology::GetNumaNodeCount()
+{
+#if defined(_WIN32)
+	ULONG highestNode = 0;
+	if (!GetNumaHighestNodeNumber(&highestNode))
+	{
+		return 1;
+	}
+
+	return (int)highestNode + 1;
+#elif defined(__linux__)
+	int count = 0;
+	while (std::ifstream("/sys/devices/system/node/node" + std::to_string(count) + "/cpulist"))
+	{
+		count++;
+	}
+
+	return count > 0 ? count : 1;
+#else
+	return 1;
+#endif
+}
+
+/**
+	Returns the logical CPUs that belong to a NUMA node. On Linux this is parsed from 
+	the node's cpulist, such as "0-15,32-47". Returns an empty list if unknown.
+*/
+std::vector<int> HostTopology::GetNodeCpus(int node)
+{
+	std::vector<int> cpus;
+
+#if defined(__linux__)
+	std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+	std::string list;
+
+	if (!std::getline(file, list))
+	{
+		return cpus;
+	}
+
+	std::stringstream stream(list);
+	std::string eachRange;
+	while (std::getline(stream, eachRange, ','))
+	{
+		size_t dash = eachRange.find('-');
+		int first = std::stoi(eachRange.substr(0, dash));
+		int last = (dash == std::string::npos) ? first : std::stoi(eachRange.substr(dash + 1));
+
+		for (int cpu = first; cpu <= last; cpu++)
+		{
+			cpus.push_back(cpu);
+		}
+	}
+#else
+	(void)node;
+#endif
+
+	return cpus;
+}
+
+/**
+	Restricts the calling thread to the CPUs of a NUMA node, so the pages it touches 
+	first are placed on that node. Returns false if the thread could not be pinned.
+*/
+bool HostTopology::PinCurrentThreadToNode(int node)
+{
+#if defined(_WIN32)
+	GROUP_AFFINITY affinity = {};
+	if (!GetNumaNodeProcessorMaskEx((USHORT)node, &affinity))
+	{
+		return false;
+	}
+
+	return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+#elif defined(__linux__)
+	std::vector<int> cpus = GetNodeCpus(node);
+	if (cpus.empty())
+	{
+		return false;
+	}
+
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	for (int eachCpu : cpus)
+	{
+		CPU_SET(eachCpu, &cpuSet);
+	}
+
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+	(void)node;
+	return false;
+#endif
+}
+
+/**
+	Returns the size in bytes of the data or unified cache at the given level (1 for 
+	L1) seen by the first CPU, or 0 if it is unknown.
+*/
+size_t HostTopology::GetCacheSize(int level)
+{
+#if defined(_WIN32)
+	DWORD bytes = 0;
+	GetLogicalProcessorInformation(nullptr, &bytes);
+	std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> entries(bytes / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+
+	if (entries.empty() || !GetLogicalProcessorInformation(entries.data(), &bytes))
+	{
+		return 0;
+	}
+
+	for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& eachEntry : entries)
+	{
+		if (eachEntry.Relationship == RelationCache && eachEntry.Cache.Level == level && 
+			(eachEntry.Cache.Type == CacheData || eachEntry.Cache.Type == CacheUnified))
+		{
+			return eachEntry.Cache.Size;
+		}
+	}
+
+	return 0;
+#elif defined(__linux__)
+	/* Each index directory describes one cache, with its size written as "48K" or "32M". */
+	for (int index = 0; ; index++)
+	{
+		std::string directory = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+		std::ifstream levelFile(directory + "level");
+		int cacheLevel = 0;
+
+		if (!(levelFile >> cacheLevel))
+		{
+			return 0;
+		}
+
+		std::string type;
+		std::ifstream(directory + "type") >> type;
+
+		if (cacheLevel != level || type == "Instruction")
+		{
+			continue;
+		}
+
+		std::string size;
+		std::ifstream(directory + "size") >> size;
+
+		if (size.empty())
+		{
+			return 0;
+		}
+
+		size_t value = std::stoul(size);
+		char unit = size.back();
+		return (unit == 'K') ? value * 1024 : (unit == 'M') ? value * 1024 * 1024 : value;
+	}
+#else
+	(void)level;
+	return 0;
+#endif
+}
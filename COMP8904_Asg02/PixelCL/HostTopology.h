@@ -0,0 +1,49 @@
+/*===================================================================================*//**
+	HostTopology
+	
+	Static class for querying the host's NUMA layout and caches, and pinning threads to 
+	nodes.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see HostTopology
+	@see HostTopology.cpp
+	
+*//*====================================================================================*/
+
+#ifndef HOST_TOPOLOGY_H
+#define HOST_TOPOLOGY_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include <vector>
+
+/*========================================================================================
+	HostTopology	
+========================================================================================*/
+/**
+	Static class for querying the host's NUMA layout and caches, and pinning threads to 
+	nodes.
+	
+	Uses sysfs and pthread affinity on Linux and the NUMA API on Windows. Elsewhere the 
+	host is treated as one node and pinning does nothing.
+	
+	@see HostTopology.cpp
+*/
+class HostTopology
+{
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static int GetNumaNodeCount();
+		static std::vector<int> GetNodeCpus(int node);
+		static bool PinCurrentThreadToNode(int node);
+		static size_t GetCacheSize(int level);
+};
+
+#endif
@@ -0,0 +1,155 @@
+__kernel void halveBrightness (	__global float4* startPixels, 
+								__global float4* resultPixels)
+{
+	const int globalId = get_global_id(0);
+	
+	float x = startPixels[globalId].x / 2;
+	float y = startPixels[globalId].y / 2;
+	float z = startPixels[globalId].z / 2;
+	float w = startPixels[globalId].w / 2;
+	float4 halfVal = {x, y, z, w};
+
+	resultPixels[globalId] = halfVal;
+}
+
+/*
+	Partial statistics for one work-group. Must match ColorPartial in ColorStatistics.h.
+*/
+typedef struct
+{
+	float4 mean;
+	float4 m2;
+	float4 min;
+	float4 max;
+	uint count;
+	uint padding[3];
+} ColorPartial;
+
+/*
+	Merges partial b into partial a using Chan's parallel formula.
+*/
+void mergeColorPartial (__local ColorPartial* a, __local ColorPartial* b)
+{
+	if (b->count == 0)
+	{
+		return;
+	}
+
+	if (a->count == 0)
+	{
+		*a = *b;
+		return;
+	}
+
+	float total = (float)a->count + (float)b->count;
+	float4 delta = b->mean - a->mean;
+	a->mean += delta * ((float)b->count / total);
+	a->m2 += b->m2 + delta * delta * ((float)a->count * ((float)b->count / total));
+	a->min = fmin(a->min, b->min);
+	a->max = fmax(a->max, b->max);
+	a->count += b->count;
+}
+
+/*
+	Computes per-channel min, max, mean and M2 in a single pass over the pixels. Each 
+	work-item runs Welford's update over a grid-strided share of the pixels, then the 
+	work-group merges its items in local memory and writes one partial.
+*/
+__kernel void computeColorStatistics (	__global const float4* pixels, 
+										const uint numPixels, 
+										__global ColorPartial* partials, 
+										__local ColorPartial* scratch)
+{
+	const uint localId = get_local_id(0);
+	const uint localSize = get_local_size(0);
+
+	uint count = 0;
+	float4 mean = (float4)(0.0f);
+	float4 m2 = (float4)(0.0f);
+	float4 minVal = (float4)(MAXFLOAT);
+	float4 maxVal = (float4)(-MAXFLOAT);
+
+	for (uint i = get_global_id(0); i < numPixels; i += get_global_size(0))
+	{
+		float4 pixel = pixels[i];
+		count++;
+		float4 delta = pixel - mean;
+		mean += delta / (float)count;
+		m2 += delta * (pixel - mean);
+		minVal = fmin(minVal, pixel);
+		maxVal = fmax(maxVal, pixel);
+	}
+
+	scratch[localId].mean = mean;
+	scratch[localId].m2 = m2;
+	scratch[localId].min = minVal;
+	scratch[localId].max = maxVal;
+	scratch[localId].count = count;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	/* Tree reduction that also handles work-group sizes that are not powers of two. */
+	for (uint active = localSize; active > 1; )
+	{
+		uint half = (active + 1) / 2;
+		if (localId + half < active)
+		{
+			mergeColorPartial(&scratch[localId], &scratch[localId + half]);
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+		active = half;
+	}
+
+	if (localId == 0)
+	{
+		partials[get_group_id(0)] = scratch[0];
+	}
+}
+
+/*
+	Per-image parameters for a batch. Must match ImageParams in PixelBatch.h.
+*/
+typedef struct
+{
+	uint offset;
+	uint numPixels;
+	float scale;
+	uint padding;
+} ImageParams;
+
+/*
+	Scales the brightness of every image in a batch in one launch. The images are packed 
+	back to back and each work-item finds its image by binary searching the offset table 
+	in constant memory. The host launches with a global offset so global IDs index the 
+	packed pixels directly.
+*/
+__kernel void scaleBrightnessBatched (	__global const float4* startPixels, 
+										__global float4* resultPixels, 
+										__constant ImageParams* images, 
+										const uint numImages, 
+										const uint endPixel)
+{
+	const uint globalId = get_global_id(0);
+
+	if (globalId >= endPixel)
+	{
+		return;
+	}
+
+	/* Find the last image that starts at or before this pixel. */
+	uint low = 0;
+	uint high = numImages - 1;
+	while (low < high)
+	{
+		uint mid = (low + high + 1) / 2;
+		if (images[mid].offset <= globalId)
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	resultPixels[globalId] = startPixels[globalId] * images[low].scale;
+}
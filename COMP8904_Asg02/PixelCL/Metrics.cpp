@@ -0,0 +1,351 @@
+/*===================================================================================*//**
+	Metrics
+	
+	Process-wide counters, gauges and latency histograms that are updated without locks 
+	and written in the Prometheus text format.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see Metrics
+	@see Metrics.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "Metrics.h"
+#include <bit>
+#include <map>
+#include <memory>
+#include <mutex>
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	One registered metric. Exactly one of the pointers is set.
+*/
+struct MetricEntry
+{
+	public:
+		std::string help;
+		std::unique_ptr<MetricCounter> counter;
+		std::unique_ptr<MetricGauge> gauge;
+		std::unique_ptr<MetricHistogram> histogram;
+};
+
+/**
+	Every registered metric, sorted by name.
+*/
+struct MetricRegistry
+{
+	public:
+		std::mutex mutex;
+		std::map<std::string, MetricEntry> entries;
+};
+
+/*----------------------------------------------------------------------------------------
+	MetricCounter
+----------------------------------------------------------------------------------------*/
+/**
+	Creates a counter at zero.
+*/
+MetricCounter::MetricCounter() : _value(0)
+{
+}
+
+/**
+	Adds to the counter.
+*/
+void MetricCounter::Add(uint64_t amount)
+{
+	_value.fetch_add(amount, std::memory_order_relaxed);
+}
+
+/**
+	Returns the counter's value.
+*/
+uint64_t MetricCounter::GetValue() const
+{
+	return _value.load(std::memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------------------
+	MetricGauge
+----------------------------------------------------------------------------------------*/
+/**
+	Creates a gauge at zero.
+*/
+MetricGauge::MetricGauge() : _value(0)
+{
+}
+
+/**
+	Sets the gauge.
+*/
+void MetricGauge::Set(double value)
+{
+	_value.store(value, std::memory_order_relaxed);
+}
+
+/**
+	Raises the gauge to the value if it is higher, for tracking peaks.
+*/
+void MetricGauge::SetMax(double value)
+{
+	double current = _value.load(std::memory_order_relaxed);
+	while (value > current && !_value.compare_exchange_weak(current, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+/**
+	Returns the gauge's value.
+*/
+double MetricGauge::GetValue() const
+{
+	return _value.load(std::memory_order_relaxed);
+}
+
+/*----------------------------------------------------------------------------------------
+	MetricHistogram
+----------------------------------------------------------------------------------------*/
+/**
+	Creates an empty histogram.
+*/
+MetricHistogram::MetricHistogram() : _count(0), _sum(0), _max(0)
+{
+	for (std::atomic<uint64_t>& eachBucket : _buckets)
+	{
+		eachBucket.store(0, std::memory_order_relaxed);
+	}
+}
+
+/**
+	Records one latency in microseconds.
+*/
+void MetricHistogram::Record(uint64_t micros)
+{
+	_buckets[GetBucket(micros)].fetch_add(1, std::memory_order_relaxed);
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_sum.fetch_add(micros, std::memory_order_relaxed);
+
+	uint64_t currentMax = _max.load(std::memory_order_relaxed);
+	while (micros > currentMax && !_max.compare_exchange_weak(currentMax, micros, std::memory_order_relaxed))
+	{
+	}
+}
+
+/**
+	Records one latency in seconds.
+*/
+void MetricHistogram::RecordSeconds(double seconds)
+{
+	Record(seconds > 0 ? (uint64_t)(seconds * 1000000.0 + 0.5) : 0);
+}
+
+/**
+	Returns the number of latencies recorded.
+*/
+uint64_t MetricHistogram::GetCount() const
+{
+	return _count.load(std::memory_order_relaxed);
+}
+
+/**
+	Returns the total of the latencies recorded, in microseconds.
+*/
+uint64_t MetricHistogram::GetSum() const
+{
+	return _sum.load(std::memory_order_relaxed);
+}
+
+/**
+	Returns the largest latency recorded, in microseconds.
+*/
+uint64_t MetricHistogram::GetMax() const
+{
+	return _max.load(std::memory_order_relaxed);
+}
+
+/**
+	Returns the latency in microseconds below which the given fraction of recordings 
+	fall, as the top of the bucket it lands in. Recordings made while the buckets are 
+	read may or may not be counted.
+*/
+uint64_t MetricHistogram::GetQuantile(double quantile) const
+{
+	uint64_t counts[HISTOGRAM_BUCKETS];
+	uint64_t total = 0;
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+	{
+		counts[i] = _buckets[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+
+	if (total == 0)
+	{
+		return 0;
+	}
+
+	uint64_t rank = (uint64_t)(quantile * (double)total + 0.5);
+	rank = (rank < 1) ? 1 : (rank > total ? total : rank);
+
+	uint64_t seen = 0;
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+	{
+		seen += counts[i];
+		if (seen >= rank)
+		{
+			uint64_t limit = GetBucketLimit(i);
+			uint64_t max = GetMax();
+			return (limit < max) ? limit : max;
+		}
+	}
+
+	return GetMax();
+}
+
+/**
+	Returns the bucket a value falls in.
+*/
+int MetricHistogram::GetBucket(uint64_t value)
+{
+	if (value < 2 * HISTOGRAM_SUB_BUCKETS)
+	{
+		return (int)value;
+	}
+
+	/* Keep the top four bits: the leading one and the sub-bucket below it. */
+	int shift = std::bit_width(value) - 4;
+	return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (int)(value >> shift) - HISTOGRAM_SUB_BUCKETS;
+}
+
+/**
+	Returns the largest value that falls in a bucket.
+*/
+uint64_t MetricHistogram::GetBucketLimit(int bucket)
+{
+	if (bucket < 2 * HISTOGRAM_SUB_BUCKETS)
+	{
+		return (uint64_t)bucket;
+	}
+
+	int shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+	uint64_t subBucket = (uint64_t)(bucket % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS);
+	return ((subBucket + 1) << shift) - 1;
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Returns the counter with the given name, creating it the first time.
+*/
+MetricCounter& Metrics::GetCounter(const std::string& name, const std::string& help)
+{
+	MetricRegistry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	MetricEntry& entry = registry.entries[name];
+
+	if (!entry.counter)
+	{
+		entry.help = help;
+		entry.counter.reset(new MetricCounter());
+	}
+
+	return *entry.counter;
+}
+
+/**
+	Returns the gauge with the given name, creating it the first time.
+*/
+MetricGauge& Metrics::GetGauge(const std::string& name, const std::string& help)
+{
+	MetricRegistry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	MetricEntry& entry = registry.entries[name];
+
+	if (!entry.gauge)
+	{
+		entry.help = help;
+		entry.gauge.reset(new MetricGauge());
+	}
+
+	return *entry.gauge;
+}
+
+/**
+	Returns the histogram with the given name, creating it the first time.
+*/
+MetricHistogram& Metrics::GetHistogram(const std::string& name, const std::string& help)
+{
+	MetricRegistry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	MetricEntry& entry = registry.entries[name];
+
+	if (!entry.histogram)
+	{
+		entry.help = help;
+		entry.histogram.reset(new MetricHistogram());
+	}
+
+	return *entry.histogram;
+}
+
+/**
+	Returns the registry. It is never freed, so metrics can still be updated and written 
+	during static destruction.
+*/
+MetricRegistry& Metrics::GetRegistry()
+{
+	static MetricRegistry* registry = new MetricRegistry();
+	return *registry;
+}
+
+/**
+	Writes every metric in the Prometheus text format. Histograms are written as 
+	summaries in seconds, with the 50th, 90th, 99th and 99.9th percentiles and a 
+	separate _max gauge.
+*/
+void Metrics::Write(std::ostream& stream)
+{
+	const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+	MetricRegistry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	for (const std::pair<const std::string, MetricEntry>& eachEntry : registry.entries)
+	{
+		const std::string& name = eachEntry.first;
+		const MetricEntry& entry = eachEntry.second;
+
+		stream << "# HELP " << name << " " << entry.help << "\n";
+
+		if (entry.counter)
+		{
+			stream << "# TYPE " << name << " counter\n" << 
+				name << " " << entry.counter->GetValue() << "\n";
+		}
+		else if (entry.gauge)
+		{
+			stream << "# TYPE " << name << " gauge\n" << 
+				name << " " << entry.gauge->GetValue() << "\n";
+		}
+		else if (entry.histogram)
+		{
+			stream << "# TYPE " << name << " summary\n";
+			for (double eachQuantile : quantiles)
+			{
+				stream << name << "{quantile=\"" << eachQuantile << "\"} " << 
+					entry.histogram->GetQuantile(eachQuantile) / 1000000.0 << "\n";
+			}
+			stream << name << "_sum " << entry.histogram->GetSum() / 1000000.0 << "\n" << 
+				name << "_count " << entry.histogram->GetCount() << "\n" << 
+				name << "_max " << entry.histogram->GetMax() / 1000000.0 << "\n";
+		}
+	}
+}
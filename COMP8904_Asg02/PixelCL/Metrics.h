@@ -0,0 +1,155 @@
+/*===================================================================================*//**
+	Metrics
+	
+	Process-wide counters, gauges and latency histograms that are updated without locks 
+	and written in the Prometheus text format.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see Metrics
+	@see Metrics.cpp
+	
+*//*====================================================================================*/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/*========================================================================================
+	Constants
+========================================================================================*/
+/** Sub-buckets per power of two in a histogram, giving at most 12.5% relative error. */
+const int HISTOGRAM_SUB_BUCKETS = 8;
+
+/** Buckets needed to cover every 64-bit value. */
+const int HISTOGRAM_BUCKETS = 62 * HISTOGRAM_SUB_BUCKETS;
+
+/*========================================================================================
+	MetricCounter
+========================================================================================*/
+/**
+	A value that only goes up, such as a number of frames or bytes.
+*/
+class MetricCounter
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::atomic<uint64_t> _value;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		MetricCounter();
+		void Add(uint64_t amount);
+		uint64_t GetValue() const;
+};
+
+/*========================================================================================
+	MetricGauge
+========================================================================================*/
+/**
+	A value that can go up and down, such as a rate, or that tracks a peak.
+*/
+class MetricGauge
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::atomic<double> _value;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		MetricGauge();
+		void Set(double value);
+		void SetMax(double value);
+		double GetValue() const;
+};
+
+/*========================================================================================
+	MetricHistogram
+========================================================================================*/
+/**
+	Distribution of latencies in microseconds, bucketed the way HDR histograms are.
+	
+	Values below 2 * HISTOGRAM_SUB_BUCKETS each have their own bucket. Above that every 
+	power of two is split into HISTOGRAM_SUB_BUCKETS equal buckets, so any quantile is 
+	within 12.5% of the true value whatever the range. Recording is a handful of 
+	relaxed atomic adds.
+*/
+class MetricHistogram
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::atomic<uint64_t> _buckets[HISTOGRAM_BUCKETS];
+		std::atomic<uint64_t> _count;
+		std::atomic<uint64_t> _sum;
+		std::atomic<uint64_t> _max;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		MetricHistogram();
+		void Record(uint64_t micros);
+		void RecordSeconds(double seconds);
+		uint64_t GetCount() const;
+		uint64_t GetSum() const;
+		uint64_t GetMax() const;
+		uint64_t GetQuantile(double quantile) const;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    private:
+		static int GetBucket(uint64_t value);
+		static uint64_t GetBucketLimit(int bucket);
+};
+
+/*========================================================================================
+	Metrics
+========================================================================================*/
+struct MetricRegistry;
+
+/**
+	Static class holding every metric in the process by name.
+	
+	Looking a metric up takes a lock, so callers look theirs up once and keep the 
+	reference. Metrics are never removed, so references stay valid for the life of the 
+	process, and updating them never locks.
+	
+	@see Metrics.cpp
+*/
+class Metrics
+{
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static MetricCounter& GetCounter(const std::string& name, const std::string& help);
+		static MetricGauge& GetGauge(const std::string& name, const std::string& help);
+		static MetricHistogram& GetHistogram(const std::string& name, const std::string& help);
+		static void Write(std::ostream& stream);
+
+    private:
+		static MetricRegistry& GetRegistry();
+};
+
+#endif
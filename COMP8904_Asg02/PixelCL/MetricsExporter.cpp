@@ -0,0 +1,310 @@
+/*===================================================================================*//**
+	MetricsExporter
+	
+	Serves the metrics over HTTP on the loopback interface and writes them to a file at 
+	a fixed interval.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see MetricsExporter
+	@see MetricsExporter.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "MetricsExporter.h"
+#include "Metrics.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#if defined(_WIN32)
+	#define NOMINMAX
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+	#pragma comment(lib, "Ws2_32.lib")
+	#define SEND_FLAGS 0
+#else
+	#include <arpa/inet.h>
+	#include <netinet/in.h>
+	#include <sys/select.h>
+	#include <sys/socket.h>
+	#include <unistd.h>
+	#define SEND_FLAGS MSG_NOSIGNAL
+#endif
+
+/*========================================================================================
+	Constants
+========================================================================================*/
+/** Returned by OpenListenSocket when the socket could not be opened. */
+const intptr_t NO_SOCKET = -1;
+
+/** How often the server checks whether it should stop, in microseconds. */
+const long SERVER_POLL_MICROS = 200000;
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates a stopped exporter.
+*/
+MetricsExporter::MetricsExporter() :
+	_isRunning(false),
+	_listenSocket(NO_SOCKET),
+	_dumpPath(""),
+	_dumpSeconds(0)
+{
+}
+
+/**
+	Stops the exporter, writing the dump file one last time.
+*/
+MetricsExporter::~MetricsExporter()
+{
+	Stop();
+}
+
+/**
+	Starts serving on 127.0.0.1 at the given port, unless it is 0, and dumping to the 
+	given path every dumpSeconds, unless it is empty. Returns false if the port could 
+	not be opened or the exporter is already running.
+*/
+bool MetricsExporter::Start(int port, const std::string& dumpPath, int dumpSeconds)
+{
+	if (_isRunning)
+	{
+		return false;
+	}
+
+	if (port != 0)
+	{
+		_listenSocket = OpenListenSocket(port);
+
+		if (_listenSocket == NO_SOCKET)
+		{
+			return false;
+		}
+	}
+
+	_dumpPath = dumpPath;
+	_dumpSeconds = (dumpSeconds > 0) ? dumpSeconds : 1;
+	_isRunning = true;
+
+	if (_listenSocket != NO_SOCKET)
+	{
+		_serverThread = std::thread(&MetricsExporter::Serve, this);
+	}
+	if (!_dumpPath.empty())
+	{
+		_dumpThread = std::thread(&MetricsExporter::DumpPeriodically, this);
+	}
+
+	return true;
+}
+
+/**
+	Stops serving and dumping, then writes the dump file once more. Safe to call more 
+	than once.
+*/
+void MetricsExporter::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (!_isRunning)
+		{
+			return;
+		}
+		_isRunning = false;
+	}
+	_stopped.notify_all();
+
+	if (_serverThread.joinable())
+	{
+		_serverThread.join();
+	}
+	if (_dumpThread.joinable())
+	{
+		_dumpThread.join();
+	}
+
+	if (_listenSocket != NO_SOCKET)
+	{
+		CloseSocket(_listenSocket);
+		_listenSocket = NO_SOCKET;
+#if defined(_WIN32)
+		WSACleanup();
+#endif
+	}
+
+	if (!_dumpPath.empty())
+	{
+		Dump();
+	}
+}
+
+/**
+	Writes the metrics to the dump file, replacing it whole. Returns false if it could 
+	not be written.
+*/
+bool MetricsExporter::Dump() const
+{
+	std::string temporaryPath = _dumpPath + ".tmp";
+
+	{
+		std::ofstream file(temporaryPath);
+		Metrics::Write(file);
+
+		if (!file)
+		{
+			return false;
+		}
+	}
+
+	/* rename will not replace an existing file on Windows. */
+#if defined(_WIN32)
+	std::remove(_dumpPath.c_str());
+#endif
+	return std::rename(temporaryPath.c_str(), _dumpPath.c_str()) == 0;
+}
+
+/**
+	Answers connections until the exporter stops. Whatever was asked for, the reply is 
+	the full set of metrics.
+*/
+void MetricsExporter::Serve()
+{
+	while (_isRunning)
+	{
+		/* Wait a short time for a connection, so a stop is noticed promptly. */
+		fd_set readable;
+		FD_ZERO(&readable);
+		FD_SET(_listenSocket, &readable);
+		timeval timeout = { 0, SERVER_POLL_MICROS };
+
+		if (select((int)_listenSocket + 1, &readable, NULL, NULL, &timeout) <= 0)
+		{
+			continue;
+		}
+
+		intptr_t client = (intptr_t)accept(_listenSocket, NULL, NULL);
+
+		if (client == NO_SOCKET)
+		{
+			continue;
+		}
+
+		/* Read the request, if it arrives in time. It is not needed beyond that. */
+		FD_ZERO(&readable);
+		FD_SET(client, &readable);
+		timeout = { 1, 0 };
+		if (select((int)client + 1, &readable, NULL, NULL, &timeout) > 0)
+		{
+			char request[1024];
+			recv(client, request, sizeof(request), 0);
+		}
+
+		std::ostringstream body;
+		Metrics::Write(body);
+		std::string content = body.str();
+		std::string response = "HTTP/1.1 200 OK\r\n"
+			"Content-Type: text/plain; version=0.0.4\r\n"
+			"Content-Length: " + std::to_string(content.size()) + "\r\n"
+			"Connection: close\r\n\r\n" + content;
+
+		size_t sent = 0;
+		while (sent < response.size())
+		{
+			int result = send(client, response.data() + sent, (int)(response.size() - sent), SEND_FLAGS);
+
+			if (result <= 0)
+			{
+				break;
+			}
+			sent += (size_t)result;
+		}
+
+		CloseSocket(client);
+	}
+}
+
+/**
+	Writes the dump file every interval until the exporter stops.
+*/
+void MetricsExporter::DumpPeriodically()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while (_isRunning)
+	{
+		_stopped.wait_for(lock, std::chrono::seconds(_dumpSeconds), [this]() { return !_isRunning; });
+
+		if (_isRunning)
+		{
+			Dump();
+		}
+	}
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Opens a socket listening on 127.0.0.1 at the given port, or returns NO_SOCKET.
+*/
+intptr_t MetricsExporter::OpenListenSocket(int port)
+{
+#if defined(_WIN32)
+	WSADATA data;
+	if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+	{
+		return NO_SOCKET;
+	}
+#endif
+
+	intptr_t listenSocket = (intptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+	if (listenSocket == NO_SOCKET)
+	{
+#if defined(_WIN32)
+		WSACleanup();
+#endif
+		return NO_SOCKET;
+	}
+
+	int reuse = 1;
+	setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+	sockaddr_in address = sockaddr_in();
+	address.sin_family = AF_INET;
+	address.sin_port = htons((unsigned short)port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (bind(listenSocket, (const sockaddr*)&address, sizeof(address)) != 0 || listen(listenSocket, 8) != 0)
+	{
+		CloseSocket(listenSocket);
+#if defined(_WIN32)
+		WSACleanup();
+#endif
+		return NO_SOCKET;
+	}
+
+	return listenSocket;
+}
+
+/**
+	Closes a socket opened by OpenListenSocket or accepted from one.
+*/
+void MetricsExporter::CloseSocket(intptr_t handle)
+{
+#if defined(_WIN32)
+	closesocket((SOCKET)handle);
+#else
+	close((int)handle);
+#endif
+}
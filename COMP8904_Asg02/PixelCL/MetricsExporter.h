@@ -0,0 +1,83 @@
+/*===================================================================================*//**
+	MetricsExporter
+	
+	Serves the metrics over HTTP on the loopback interface and writes them to a file at 
+	a fixed interval.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see MetricsExporter
+	@see MetricsExporter.cpp
+	
+*//*====================================================================================*/
+
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/*========================================================================================
+	MetricsExporter
+========================================================================================*/
+/**
+	Exports Metrics while a run is in progress.
+	
+	The HTTP endpoint answers every request on 127.0.0.1 with the metrics in the 
+	Prometheus text format, so it can be scraped or read with curl. The dump file is 
+	replaced whole each interval, so readers never see a half-written file, and written 
+	once more when the exporter stops. Each runs on its own thread and reads the 
+	metrics without blocking the threads that update them.
+	
+	@see MetricsExporter.cpp
+*/
+class MetricsExporter
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::atomic<bool> _isRunning;
+		intptr_t _listenSocket;
+		std::string _dumpPath;
+		int _dumpSeconds;
+		std::thread _serverThread;
+		std::thread _dumpThread;
+		std::mutex _mutex;
+		std::condition_variable _stopped;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		MetricsExporter();
+		~MetricsExporter();
+		MetricsExporter(const MetricsExporter&) = delete;
+		MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+		bool Start(int port, const std::string& dumpPath, int dumpSeconds);
+		void Stop();
+		bool Dump() const;
+
+    private:
+		void Serve();
+		void DumpPeriodically();
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    private:
+		static intptr_t OpenListenSocket(int port);
+		static void CloseSocket(intptr_t handle);
+};
+
+#endif
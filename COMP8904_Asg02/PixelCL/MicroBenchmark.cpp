@@ -0,0 +1,254 @@
+/*===================================================================================*//**
+	MicroBenchmark
+	
+	Repeated, calibrated timing of small host functions, with summary statistics and 
+	comparison against a saved baseline.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see MicroBenchmark
+	@see MicroBenchmark.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "MicroBenchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+/*========================================================================================
+	Constants
+========================================================================================*/
+/** Iterations are never calibrated past this, however fast the body is. */
+const uint64_t MAX_ITERATIONS = (uint64_t)1 << 30;
+
+/** Written by KeepAlive so the compiler must compute the value. */
+volatile float _keepAliveSink = 0;
+
+/*----------------------------------------------------------------------------------------
+	BenchmarkResult
+----------------------------------------------------------------------------------------*/
+/**
+	Returns the bytes processed per second at the median time.
+*/
+double BenchmarkResult::GetBytesPerSecond() const
+{
+	return (medianNanos > 0) ? bytesPerIteration / (medianNanos * 1e-9) : 0;
+}
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates a harness that times each benchmark repetitions times, for at least 
+	minSeconds each, and skips benchmarks whose names do not contain filter.
+*/
+MicroBenchmark::MicroBenchmark(int repetitions, double minSeconds, const std::string& filter) : 
+	_repetitions(std::max(repetitions, 1)), 
+	_minSeconds(minSeconds > 0 ? minSeconds : 0.05), 
+	_filter(filter)
+{
+}
+
+/**
+	Times a benchmark and adds its result. Returns false if the filter skipped it.
+*/
+bool MicroBenchmark::Run(const std::string& name, size_t bytesPerIteration, const std::function<void()>& body)
+{
+	if (!_filter.empty() && name.find(_filter) == std::string::npos)
+	{
+		return false;
+	}
+
+	/* Warm the caches and page in the buffers, then grow the iteration count until one 
+	repetition takes the minimum time. */
+	body();
+	uint64_t iterations = 1;
+	double seconds = TimeIterations(body, iterations);
+
+	while (seconds < _minSeconds && iterations < MAX_ITERATIONS)
+	{
+		double scale = (seconds > 0) ? std::min(10.0, std::max(2.0, 1.4 * _minSeconds / seconds)) : 10.0;
+		iterations = std::min(MAX_ITERATIONS, (uint64_t)(iterations * scale));
+		seconds = TimeIterations(body, iterations);
+	}
+
+	BenchmarkResult result = BenchmarkResult();
+	result.name = name;
+	result.bytesPerIteration = bytesPerIteration;
+	result.iterations = iterations;
+
+	for (int repetition = 0; repetition < _repetitions; repetition++)
+	{
+		result.repetitionNanos.push_back(TimeIterations(body, iterations) * 1e9 / iterations);
+	}
+
+	std::vector<double> sorted = result.repetitionNanos;
+	std::sort(sorted.begin(), sorted.end());
+	size_t count = sorted.size();
+
+	double sum = 0;
+	for (double eachNanos : sorted)
+	{
+		sum += eachNanos;
+	}
+	result.meanNanos = sum / count;
+	result.medianNanos = (count % 2 == 1) ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+	result.minNanos = sorted[0];
+
+	double squares = 0;
+	for (double eachNanos : sorted)
+	{
+		squares += (eachNanos - result.meanNanos) * (eachNanos - result.meanNanos);
+	}
+	result.stddevNanos = (count > 1) ? std::sqrt(squares / (count - 1)) : 0;
+
+	_results.push_back(result);
+	return true;
+}
+
+/**
+	Loads a baseline written by SaveBaseline. Returns false if it cannot be read.
+*/
+bool MicroBenchmark::LoadBaseline(const std::string& path)
+{
+	std::ifstream file(path);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		size_t equals = line.find('=');
+
+		if (line.empty() || line[0] == '#' || equals == std::string::npos)
+		{
+			continue;
+		}
+
+		std::string name = line.substr(0, equals);
+		name.erase(name.find_last_not_of(" \t") + 1);
+
+		BenchmarkBaseline baseline = BenchmarkBaseline();
+		std::istringstream values(line.substr(equals + 1));
+		values >> baseline.medianNanos >> baseline.stddevNanos;
+		_baseline[name] = baseline;
+	}
+
+	return true;
+}
+
+/**
+	Saves the median and standard deviation of every result, one "name = median 
+	stddev" line each in nanoseconds. Returns false if it could not be written.
+*/
+bool MicroBenchmark::SaveBaseline(const std::string& path) const
+{
+	std::ofstream file(path);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file << "# Median and standard deviation in nanoseconds per iteration.\n";
+	for (const BenchmarkResult& eachResult : _results)
+	{
+		file << eachResult.name << " = " << eachResult.medianNanos << " " << eachResult.stddevNanos << "\n";
+	}
+
+	return (bool)file;
+}
+
+/**
+	Returns every result so far, in the order they ran.
+*/
+const std::vector<BenchmarkResult>& MicroBenchmark::GetResults() const
+{
+	return _results;
+}
+
+/**
+	Prints one result as a row under PrintHeader, with its change from the baseline.
+*/
+void MicroBenchmark::Print(std::ostream& stream, const BenchmarkResult& result) const
+{
+	std::ios_base::fmtflags flags = stream.flags();
+	std::streamsize precision = stream.precision();
+	double cv = (result.meanNanos > 0) ? 100.0 * result.stddevNanos / result.meanNanos : 0;
+
+	stream << std::left << std::setw(40) << result.name << std::right << std::fixed << std::setprecision(1) << 
+		std::setw(14) << result.medianNanos << 
+		std::setw(14) << result.meanNanos << 
+		std::setw(9) << cv << "%" << 
+		std::setw(14) << result.minNanos << 
+		std::setw(10) << result.GetBytesPerSecond() / 1e9 << 
+		std::setw(12) << result.iterations << " x " << result.repetitionNanos.size();
+
+	std::map<std::string, BenchmarkBaseline>::const_iterator found = _baseline.find(result.name);
+	if (found != _baseline.end() && found->second.medianNanos > 0)
+	{
+		const BenchmarkBaseline& baseline = found->second;
+		double change = 100.0 * (result.medianNanos - baseline.medianNanos) / baseline.medianNanos;
+		double noise = 2 * std::sqrt(result.stddevNanos * result.stddevNanos + baseline.stddevNanos * baseline.stddevNanos);
+		bool isSignificant = std::fabs(result.medianNanos - baseline.medianNanos) > noise;
+
+		stream << "   " << std::showpos << change << std::noshowpos << "% " << 
+			(!isSignificant ? "(within noise)" : (change < 0 ? "(faster)" : "(slower)"));
+	}
+
+	stream << "\n";
+	stream.flags(flags);
+	stream.precision(precision);
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Stores a value where the compiler cannot prove it unused.
+*/
+void MicroBenchmark::KeepAlive(float value)
+{
+	_keepAliveSink = value;
+}
+
+/**
+	Prints the column headings for Print.
+*/
+void MicroBenchmark::PrintHeader(std::ostream& stream)
+{
+	stream << std::left << std::setw(40) << "Benchmark" << std::right << 
+		std::setw(14) << "Median ns" << 
+		std::setw(14) << "Mean ns" << 
+		std::setw(10) << "CV" << 
+		std::setw(14) << "Min ns" << 
+		std::setw(10) << "GB/s" << 
+		std::setw(16) << "Iterations" << "   vs baseline\n";
+}
+
+/**
+	Returns the seconds taken by the given number of calls to the body.
+*/
+double MicroBenchmark::TimeIterations(const std::function<void()>& body, uint64_t iterations)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		body();
+	}
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,113 @@
+/*===================================================================================*//**
+	MicroBenchmark
+	
+	Repeated, calibrated timing of small host functions, with summary statistics and 
+	comparison against a saved baseline.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see MicroBenchmark
+	@see MicroBenchmark.cpp
+	
+*//*====================================================================================*/
+
+#ifndef MICRO_BENCHMARK_H
+#define MICRO_BENCHMARK_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	The timings of one benchmark, in nanoseconds per iteration.
+*/
+struct BenchmarkResult
+{
+	public:
+		std::string name;
+		size_t bytesPerIteration;
+		uint64_t iterations;
+		std::vector<double> repetitionNanos;
+		double meanNanos;
+		double medianNanos;
+		double stddevNanos;
+		double minNanos;
+
+		double GetBytesPerSecond() const;
+};
+
+/**
+	A saved median and standard deviation to compare a result against.
+*/
+struct BenchmarkBaseline
+{
+	public:
+		double medianNanos;
+		double stddevNanos;
+};
+
+/*========================================================================================
+	MicroBenchmark
+========================================================================================*/
+/**
+	A small harness in the style of Google Benchmark, without the dependency.
+	
+	Run calibrates how many iterations of the body fill the minimum time, then times 
+	that many iterations once per repetition. The median of the repetitions is the 
+	headline figure, with the mean, standard deviation and minimum alongside so noisy 
+	runs stand out. When a baseline is loaded, each result is compared with it, and a 
+	change is only called faster or slower when it is larger than twice the combined 
+	standard deviation.
+	
+	The body must leave its result somewhere the compiler cannot see through, such as 
+	a buffer owned by the caller or KeepAlive, or the work may be optimized away.
+	
+	@see MicroBenchmark.cpp
+*/
+class MicroBenchmark
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		int _repetitions;
+		double _minSeconds;
+		std::string _filter;
+		std::vector<BenchmarkResult> _results;
+		std::map<std::string, BenchmarkBaseline> _baseline;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		MicroBenchmark(int repetitions, double minSeconds, const std::string& filter);
+		bool Run(const std::string& name, size_t bytesPerIteration, const std::function<void()>& body);
+		bool LoadBaseline(const std::string& path);
+		bool SaveBaseline(const std::string& path) const;
+		const std::vector<BenchmarkResult>& GetResults() const;
+		void Print(std::ostream& stream, const BenchmarkResult& result) const;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static void KeepAlive(float value);
+		static void PrintHeader(std::ostream& stream);
+
+    private:
+		static double TimeIterations(const std::function<void()>& body, uint64_t iterations);
+};
+
+#endif
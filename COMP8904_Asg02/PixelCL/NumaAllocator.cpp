@@ -0,0 +1,325 @@
+/*===================================================================================*//**
+	NumaAllocator
+	
+	Static class for spreading the pages of host pixel buffers across NUMA nodes, and 
+	for initializing them in parallel from threads on the matching nodes.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see NumaAllocator
+	@see NumaAllocator.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "NumaAllocator.h"
+#include "HostTopology.h"
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#ifdef PIXELCL_HAVE_LIBNUMA
+	#include <numa.h>
+#endif
+
+/*----------------------------------------------------------------------------------------
+	Constants
+----------------------------------------------------------------------------------------*/
+/** Granularity at which pages are placed on nodes. */
+const size_t NUMA_PAGE_SIZE = 4096;
+
+/** Timed reads of each node's share. The first is a warm-up and the fastest of the rest is kept. */
+const int BANDWIDTH_RUNS = 5;
+
+/** How many times larger than the last-level cache a buffer must be to measure memory. */
+const size_t BANDWIDTH_CACHE_MULTIPLE = 4;
+
+/** Last-level cache size assumed when the host does not report one. */
+const size_t DEFAULT_LAST_LEVEL_CACHE_SIZE = (size_t)32 * 1024 * 1024;
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Applies the policy to memory that has not been touched yet, such as a fresh buffer 
+	from PixelBufferPool. Without libnuma this does nothing and placement is left to 
+	first touch in ParallelInitialize.
+*/
+void NumaAllocator::Bind(void* buffer, size_t bytes, NumaPolicy policy)
+{
+#ifdef PIXELCL_HAVE_LIBNUMA
+	if (!buffer || numa_available() < 0)
+	{
+		return;
+	}
+
+	if (policy == NUMA_INTERLEAVE)
+	{
+		numa_interleave_memory(buffer, bytes, numa_all_nodes_ptr);
+		return;
+	}
+
+	/* Bind each node's contiguous block before anything touches it. */
+	int numNodes = HostTopology::GetNumaNodeCount();
+	size_t pages = (bytes + NUMA_PAGE_SIZE - 1) / NUMA_PAGE_SIZE;
+	size_t pagesPerNode = (pages + numNodes - 1) / numNodes;
+
+	for (int node = 0; node < numNodes; node++)
+	{
+		size_t start = std::min(node * pagesPerNode * NUMA_PAGE_SIZE, bytes);
+		size_t end = std::min(start + pagesPerNode * NUMA_PAGE_SIZE, bytes);
+
+		if (end > start)
+		{
+			numa_tonode_memory((char*)buffer + start, end - start, node);
+		}
+	}
+#else
+	(void)buffer;
+	(void)bytes;
+	(void)policy;
+#endif
+}
+
+/**
+	Calls initialize for every element, split between threads pinned to each NUMA node. 
+	Each node covers the pages the policy places on it, so first touch and any later 
+	compute split the same way line up.
+*/
+void NumaAllocator::ParallelInitialize(size_t numElements, size_t elementSize, NumaPolicy policy, RangeFunction initialize)
+{
+	int numNodes = HostTopology::GetNumaNodeCount();
+	int threadsPerNode = GetThreadsPerNode();
+	std::vector<std::thread> threads;
+
+	for (int node = 0; node < numNodes; node++)
+	{
+		for (int thread = 0; thread < threadsPerNode; thread++)
+		{
+			threads.push_back(std::thread([=]()
+			{
+				HostTopology::PinCurrentThreadToNode(node);
+				ForEachRange(node, thread, threadsPerNode, numElements, elementSize, policy, initialize);
+			}));
+		}
+	}
+
+	for (std::thread& eachThread : threads)
+	{
+		eachThread.join();
+	}
+}
+
+/**
+	Measures the read bandwidth of each node's share of a buffer, in GB/s, using all 
+	of that node's threads. Nodes are measured one at a time so they do not compete. 
+	A buffer too small to spill out of the last-level cache is measured with a larger 
+	scratch buffer placed by the same policy instead, so memory rather than cache is 
+	measured.
+*/
+std::vector<double> NumaAllocator::MeasureNodeBandwidth(const void* buffer, size_t bytes, NumaPolicy policy)
+{
+	int numNodes = HostTopology::GetNumaNodeCount();
+	int threadsPerNode = GetThreadsPerNode();
+	std::vector<double> bandwidth(numNodes, 0);
+
+	size_t minBytes = GetLastLevelCacheSize() * BANDWIDTH_CACHE_MULTIPLE;
+	std::unique_ptr<float[]> scratch;
+	if (bytes < minBytes)
+	{
+		/* Left uninitialized so the policy can still place the pages, with an extra page 
+		so the values can start on a page boundary as binding requires. */
+		bytes = minBytes;
+		scratch.reset(new float[(bytes + NUMA_PAGE_SIZE) / sizeof(float)]);
+		void* alignedScratch = scratch.get();
+		size_t space = bytes + NUMA_PAGE_SIZE;
+		float* scratchValues = (float*)std::align(NUMA_PAGE_SIZE, bytes, alignedScratch, space);
+		Bind(scratchValues, bytes, policy);
+
+		ParallelInitialize(bytes / sizeof(float), sizeof(float), policy, [scratchValues](int, size_t first, size_t count)
+		{
+			std::fill(scratchValues + first, scratchValues + first + count, 1.0f);
+		});
+		buffer = scratchValues;
+	}
+
+	const float* values = (const float*)buffer;
+	size_t numValues = bytes / sizeof(float);
+
+	for (int node = 0; node < numNodes; node++)
+	{
+		/* The threads are started and pinned before any timing, then released together 
+		at the start of each run and met again at its end. */
+		std::barrier<> sync(threadsPerNode + 1);
+		std::vector<size_t> threadBytes(threadsPerNode, 0);
+		std::vector<std::thread> threads;
+
+		for (int thread = 0; thread < threadsPerNode; thread++)
+		{
+			threads.push_back(std::thread([&, node, thread]()
+			{
+				HostTopology::PinCurrentThreadToNode(node);
+				volatile float sink = 0;
+
+				for (int run = 0; run <= BANDWIDTH_RUNS; run++)
+				{
+					size_t readBytes = 0;
+					sync.arrive_and_wait();
+					ForEachRange(node, thread, threadsPerNode, numValues, sizeof(float), policy, 
+						[&](int, size_t first, size_t count)
+						{
+							sink = sink + SumRange(values + first, count);
+							readBytes += count * sizeof(float);
+						});
+					threadBytes[thread] = readBytes;
+					sync.arrive_and_wait();
+				}
+			}));
+		}
+
+		double bestSeconds = 0;
+		for (int run = 0; run <= BANDWIDTH_RUNS; run++)
+		{
+			sync.arrive_and_wait();
+			auto start = std::chrono::steady_clock::now();
+			sync.arrive_and_wait();
+
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (run > 0 && (bestSeconds == 0 || seconds < bestSeconds))
+			{
+				bestSeconds = seconds;
+			}
+		}
+
+		for (std::thread& eachThread : threads)
+		{
+			eachThread.join();
+		}
+
+		size_t nodeBytes = 0;
+		for (size_t eachBytes : threadBytes)
+		{
+			nodeBytes += eachBytes;
+		}
+		bandwidth[node] = (bestSeconds > 0) ? nodeBytes / bestSeconds / 1e9 : 0;
+	}
+
+	return bandwidth;
+}
+
+/**
+	Returns the policy named by "interleave" or "partition". Defaults to partition.
+*/
+NumaPolicy NumaAllocator::ParsePolicy(const std::string& name)
+{
+	return (name == "interleave") ? NUMA_INTERLEAVE : NUMA_PARTITION;
+}
+
+/**
+	Returns the name of a policy.
+*/
+const char* NumaAllocator::GetPolicyName(NumaPolicy policy)
+{
+	return (policy == NUMA_INTERLEAVE) ? "interleave" : "partition";
+}
+
+/**
+	Returns how many threads to run on each node, sharing the hardware threads evenly.
+*/
+int NumaAllocator::GetThreadsPerNode()
+{
+	int numNodes = HostTopology::GetNumaNodeCount();
+	return std::max(1, (int)std::thread::hardware_concurrency() / numNodes);
+}
+
+/**
+	Returns the size of the last-level cache, or a typical size if the host does not 
+	report one.
+*/
+size_t NumaAllocator::GetLastLevelCacheSize()
+{
+	for (int level = 3; level >= 1; level--)
+	{
+		size_t cacheSize = HostTopology::GetCacheSize(level);
+		if (cacheSize > 0)
+		{
+			return cacheSize;
+		}
+	}
+
+	return DEFAULT_LAST_LEVEL_CACHE_SIZE;
+}
+
+/**
+	Returns the sum of count floats. Eight partial sums are kept so that each add does 
+	not wait on the one before it, which also lets the compiler vectorize the loop.
+*/
+float NumaAllocator::SumRange(const float* values, size_t count)
+{
+	float sums[8] = {};
+	size_t i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		for (int lane = 0; lane < 8; lane++)
+		{
+			sums[lane] += values[i + lane];
+		}
+	}
+
+	for (; i < count; i++)
+	{
+		sums[0] += values[i];
+	}
+
+	float sum = 0;
+	for (float eachSum : sums)
+	{
+		sum += eachSum;
+	}
+	return sum;
+}
+
+/**
+	Calls function for one thread's share of the ranges that the policy places on the 
+	given node. Partitioned nodes split their block into contiguous slices, one per 
+	thread. Interleaved nodes deal their pages out to the threads in turn.
+*/
+void NumaAllocator::ForEachRange(
+	int node, int thread, int numThreads, 
+	size_t numElements, size_t elementSize, NumaPolicy policy, RangeFunction function)
+{
+	int numNodes = HostTopology::GetNumaNodeCount();
+	size_t elementsPerPage = std::max<size_t>(1, NUMA_PAGE_SIZE / elementSize);
+	size_t numPages = (numElements + elementsPerPage - 1) / elementsPerPage;
+
+	if (policy == NUMA_INTERLEAVE)
+	{
+		size_t stride = (size_t)numNodes * numThreads;
+		for (size_t page = node + (size_t)thread * numNodes; page < numPages; page += stride)
+		{
+			size_t first = page * elementsPerPage;
+			function(node, first, std::min(elementsPerPage, numElements - first));
+		}
+
+		return;
+	}
+
+	size_t pagesPerNode = (numPages + numNodes - 1) / numNodes;
+	size_t pagesPerThread = (pagesPerNode + numThreads - 1) / numThreads;
+	size_t firstPage = node * pagesPerNode + thread * pagesPerThread;
+	size_t endPage = std::min(std::min(firstPage + pagesPerThread, (node + 1) * pagesPerNode), numPages);
+
+	if (endPage > firstPage)
+	{
+		size_t first = firstPage * elementsPerPage;
+		size_t end = std::min(endPage * elementsPerPage, numElements);
+		function(node, first, end - first);
+	}
+}
@@ -0,0 +1,82 @@
+/*===================================================================================*//**
+	NumaAllocator
+	
+	Static class for spreading the pages of host pixel buffers across NUMA nodes, and 
+	for initializing them in parallel from threads on the matching nodes.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see NumaAllocator
+	@see NumaAllocator.cpp
+	
+*//*====================================================================================*/
+
+#ifndef NUMA_ALLOCATOR_H
+#define NUMA_ALLOCATOR_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*========================================================================================
+	Enums
+========================================================================================*/
+/**
+	How the pages of a buffer are spread across NUMA nodes.
+	
+	NUMA_PARTITION gives each node one contiguous block, matching a compute split into 
+	one contiguous range per node. NUMA_INTERLEAVE deals pages out to the nodes in turn, 
+	which suits access patterns that are not partitioned.
+*/
+enum NumaPolicy
+{
+	NUMA_PARTITION,
+	NUMA_INTERLEAVE
+};
+
+/*========================================================================================
+	NumaAllocator	
+========================================================================================*/
+/**
+	Static class for NUMA-aware host buffers.
+	
+	With libnuma (PIXELCL_HAVE_LIBNUMA) the policy is applied to the pages directly. 
+	Without it the pages must be left untouched until ParallelInitialize places them by 
+	first touch from threads pinned to each node.
+	
+	@see NumaAllocator.cpp
+*/
+class NumaAllocator
+{
+	/*------------------------------------------------------------------------------------
+		Types
+	------------------------------------------------------------------------------------*/
+    public:
+		typedef std::function<void(int node, size_t first, size_t count)> RangeFunction;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static void Bind(void* buffer, size_t bytes, NumaPolicy policy);
+		static void ParallelInitialize(size_t numElements, size_t elementSize, NumaPolicy policy, RangeFunction initialize);
+		static std::vector<double> MeasureNodeBandwidth(const void* buffer, size_t bytes, NumaPolicy policy);
+		static NumaPolicy ParsePolicy(const std::string& name);
+		static const char* GetPolicyName(NumaPolicy policy);
+
+    private:
+		static int GetThreadsPerNode();
+		static size_t GetLastLevelCacheSize();
+		static float SumRange(const float* values, size_t count);
+		static void ForEachRange(
+			int node, int thread, int numThreads, 
+			size_t numElements, size_t elementSize, NumaPolicy policy, RangeFunction function);
+};
+
+#endif
@@ -0,0 +1,353 @@
+/*===================================================================================*//**
+	PerfCounters
+	
+	Hardware performance counters for host regions, read through perf_event_open on 
+	Linux.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see PerfCounters
+	@see PerfCounters.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "PerfCounters.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#if defined(__linux__)
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+/*========================================================================================
+	Constants
+========================================================================================*/
+/** File descriptor of an event that is not open. */
+const int NO_PERF_FILE = -1;
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates closed counters.
+*/
+PerfCounters::PerfCounters() : 
+	_isScaled(false), 
+	_error("")
+{
+	for (int i = 0; i < PERF_EVENT_COUNT; i++)
+	{
+		_files[i] = NO_PERF_FILE;
+		_counts[i] = 0;
+	}
+}
+
+/**
+	Closes the counters.
+*/
+PerfCounters::~PerfCounters()
+{
+	Close();
+}
+
+/**
+	Opens every event the kernel allows. Returns false, with the reason in GetError, if 
+	none could be opened.
+*/
+bool PerfCounters::Open()
+{
+	Close();
+
+#if defined(__linux__)
+	const uint32_t types[PERF_EVENT_COUNT] = {
+		PERF_TYPE_HARDWARE, 
+		PERF_TYPE_HARDWARE, 
+		PERF_TYPE_HARDWARE, 
+		PERF_TYPE_HW_CACHE, 
+		PERF_TYPE_HARDWARE
+	};
+	const uint64_t configs[PERF_EVENT_COUNT] = {
+		PERF_COUNT_HW_CPU_CYCLES, 
+		PERF_COUNT_HW_INSTRUCTIONS, 
+		PERF_COUNT_HW_CACHE_MISSES, 
+		PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), 
+		PERF_COUNT_HW_BRANCH_MISSES
+	};
+
+	int openError = 0;
+	bool isAnyOpen = false;
+
+	for (int i = 0; i < PERF_EVENT_COUNT; i++)
+	{
+		perf_event_attr attributes;
+		std::memset(&attributes, 0, sizeof(attributes));
+		attributes.size = sizeof(attributes);
+		attributes.type = types[i];
+		attributes.config = configs[i];
+		attributes.disabled = 1;
+		attributes.inherit = 0;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		/* This process on any CPU. User space only, which perf_event_paranoid 2 allows. */
+		_files[i] = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+
+		if (_files[i] < 0)
+		{
+			_files[i] = NO_PERF_FILE;
+			openError = (openError != 0) ? openError : errno;
+		}
+		else
+		{
+			isAnyOpen = true;
+		}
+	}
+
+	if (isAnyOpen)
+	{
+		return true;
+	}
+
+	if (openError == EACCES || openError == EPERM)
+	{
+		std::string paranoid = "unknown";
+		std::ifstream file("/proc/sys/kernel/perf_event_paranoid");
+		file >> paranoid;
+		_error = "access to hardware counters is not allowed (perf_event_paranoid is " + paranoid + 
+			"; 2 or lower is needed, or CAP_PERFMON)";
+	}
+	else if (openError == ENOENT || openError == EOPNOTSUPP)
+	{
+		_error = "the CPU or hypervisor exposes none of the hardware counters";
+	}
+	else
+	{
+		_error = std::string("no hardware counters are available (") + std::strerror(openError) + ")";
+	}
+#else
+	_error = "hardware counters are only read on Linux";
+#endif
+
+	return false;
+}
+
+/**
+	Returns whether any event is open.
+*/
+bool PerfCounters::IsOpen() const
+{
+	for (int eachFile : _files)
+	{
+		if (eachFile != NO_PERF_FILE)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+	Returns why Open failed.
+*/
+const std::string& PerfCounters::GetError() const
+{
+	return _error;
+}
+
+/**
+	Zeroes and starts every open event.
+*/
+void PerfCounters::Start()
+{
+#if defined(__linux__)
+	for (int eachFile : _files)
+	{
+		if (eachFile != NO_PERF_FILE)
+		{
+			ioctl(eachFile, PERF_EVENT_IOC_RESET, 0);
+			ioctl(eachFile, PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#endif
+}
+
+/**
+	Stops every open event and reads its count, scaled up if the kernel only counted it 
+	for part of the region.
+*/
+void PerfCounters::Stop()
+{
+#if defined(__linux__)
+	for (int eachFile : _files)
+	{
+		if (eachFile != NO_PERF_FILE)
+		{
+			ioctl(eachFile, PERF_EVENT_IOC_DISABLE, 0);
+		}
+	}
+
+	_isScaled = false;
+	for (int i = 0; i < PERF_EVENT_COUNT; i++)
+	{
+		/* The value, then the time enabled and the time running. */
+		uint64_t values[3] = { 0, 0, 0 };
+		_counts[i] = 0;
+
+		if (_files[i] == NO_PERF_FILE || read(_files[i], values, sizeof(values)) != (ssize_t)sizeof(values))
+		{
+			continue;
+		}
+
+		if (values[2] > 0 && values[2] < values[1])
+		{
+			values[0] = (uint64_t)((double)values[0] * values[1] / values[2]);
+			_isScaled = true;
+		}
+		_counts[i] = values[0];
+	}
+#endif
+}
+
+/**
+	Returns whether an event is open.
+*/
+bool PerfCounters::IsCounted(PerfEvent event) const
+{
+	return _files[event] != NO_PERF_FILE;
+}
+
+/**
+	Returns an event's count in the last region, or 0 if it is not counted.
+*/
+uint64_t PerfCounters::GetCount(PerfEvent event) const
+{
+	return _counts[event];
+}
+
+/**
+	Returns the instructions per cycle in the last region, or 0 if either is not counted.
+*/
+double PerfCounters::GetIpc() const
+{
+	if (_counts[PERF_CYCLES] == 0)
+	{
+		return 0;
+	}
+
+	return (double)_counts[PERF_INSTRUCTIONS] / _counts[PERF_CYCLES];
+}
+
+/**
+	Prints the counts of the last region under the region's name.
+*/
+void PerfCounters::Print(std::ostream& stream, const std::string& regionName) const
+{
+	stream << "Hardware counters for " << regionName << (_isScaled ? " (scaled for multiplexing)" : "") << ":\n";
+
+	for (int i = 0; i < PERF_EVENT_COUNT; i++)
+	{
+		PerfEvent event = (PerfEvent)i;
+		stream << "\t" << GetEventName(event) << ": ";
+
+		if (IsCounted(event))
+		{
+			stream << _counts[i] << "\n";
+		}
+		else
+		{
+			stream << "not counted\n";
+		}
+
+		if (event == PERF_INSTRUCTIONS && IsCounted(PERF_CYCLES) && IsCounted(PERF_INSTRUCTIONS))
+		{
+			stream << "\tIPC: " << GetIpc() << "\n";
+		}
+	}
+	stream << "\n";
+}
+
+/**
+	Closes every open event.
+*/
+void PerfCounters::Close()
+{
+	for (int& eachFile : _files)
+	{
+#if defined(__linux__)
+		if (eachFile != NO_PERF_FILE)
+		{
+			close(eachFile);
+		}
+#endif
+		eachFile = NO_PERF_FILE;
+	}
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Returns the name an event is printed with.
+*/
+const char* PerfCounters::GetEventName(PerfEvent event)
+{
+	switch (event)
+	{
+		case PERF_CYCLES: return "Cycles";
+		case PERF_INSTRUCTIONS: return "Instructions";
+		case PERF_LLC_MISSES: return "LLC misses";
+		case PERF_DTLB_MISSES: return "dTLB misses";
+		case PERF_BRANCH_MISSES: return "Branch misses";
+		default: return "Unknown";
+	}
+}
+
+/*----------------------------------------------------------------------------------------
+	PerfRegion
+----------------------------------------------------------------------------------------*/
+/**
+	Starts counting if the counters are open.
+*/
+PerfRegion::PerfRegion(PerfCounters& counters, const char* name, std::ostream& stream) : 
+	_counters(counters), 
+	_name(name), 
+	_stream(stream), 
+	_isCounting(counters.IsOpen())
+{
+	if (_isCounting)
+	{
+		_counters.Start();
+	}
+}
+
+/**
+	Ends the region if End was not called.
+*/
+PerfRegion::~PerfRegion()
+{
+	End();
+}
+
+/**
+	Stops counting and prints the counts. Later calls do nothing.
+*/
+void PerfRegion::End()
+{
+	if (_isCounting)
+	{
+		_counters.Stop();
+		_counters.Print(_stream, _name);
+		_isCounting = false;
+	}
+}
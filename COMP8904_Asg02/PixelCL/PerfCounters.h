@@ -0,0 +1,129 @@
+/*===================================================================================*//**
+	PerfCounters
+	
+	Hardware performance counters for host regions, read through perf_event_open on 
+	Linux.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see PerfCounters
+	@see PerfCounters.cpp
+	
+*//*====================================================================================*/
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/*========================================================================================
+	Enums
+========================================================================================*/
+/**
+	The hardware events counted for each region.
+*/
+enum PerfEvent
+{
+	PERF_CYCLES,
+	PERF_INSTRUCTIONS,
+	PERF_LLC_MISSES,
+	PERF_DTLB_MISSES,
+	PERF_BRANCH_MISSES,
+	PERF_EVENT_COUNT
+};
+
+/*========================================================================================
+	PerfCounters
+========================================================================================*/
+/**
+	Counts cycles, instructions, last-level cache misses, dTLB misses and branch misses 
+	in user space for the thread that opened them. Threads started later, such as the 
+	background set-up or the submission threads, are not counted.
+	
+	Each event is opened on its own, so an event the CPU or hypervisor does not expose 
+	is reported as not counted while the rest still work. If the kernel forbids access 
+	(perf_event_paranoid above 2, or a container without CAP_PERFMON), or the platform 
+	is not Linux, Open fails with a reason and Start and Stop do nothing, so callers can 
+	wrap regions unconditionally. When the kernel multiplexes events, the counts are 
+	scaled up to the full region.
+	
+	@see PerfCounters.cpp
+*/
+class PerfCounters
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		int _files[PERF_EVENT_COUNT];
+		uint64_t _counts[PERF_EVENT_COUNT];
+		bool _isScaled;
+		std::string _error;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		PerfCounters();
+		~PerfCounters();
+		PerfCounters(const PerfCounters&) = delete;
+		PerfCounters& operator=(const PerfCounters&) = delete;
+
+		bool Open();
+		bool IsOpen() const;
+		const std::string& GetError() const;
+		void Start();
+		void Stop();
+		bool IsCounted(PerfEvent event) const;
+		uint64_t GetCount(PerfEvent event) const;
+		double GetIpc() const;
+		void Print(std::ostream& stream, const std::string& regionName) const;
+
+    private:
+		void Close();
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static const char* GetEventName(PerfEvent event);
+};
+
+/*========================================================================================
+	PerfRegion
+========================================================================================*/
+/**
+	Counts a host region from construction until End or destruction, then prints the 
+	counts. Does nothing if the counters are not open.
+*/
+class PerfRegion
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		PerfCounters& _counters;
+		const char* _name;
+		std::ostream& _stream;
+		bool _isCounting;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		PerfRegion(PerfCounters& counters, const char* name, std::ostream& stream);
+		~PerfRegion();
+		PerfRegion(const PerfRegion&) = delete;
+		PerfRegion& operator=(const PerfRegion&) = delete;
+
+		void End();
+};
+
+#endif
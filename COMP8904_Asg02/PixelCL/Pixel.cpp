@@ -0,0 +1,189 @@
+/*===================================================================================*//**
+	Pixel
+	
+	Static class for pixel utilities.
+    
+    Copyright 2017 Erick Fernandez de Arteaga. All rights reserved.
+        https://www.linkedin.com/in/erick-fda
+        https://bitbucket.org/erick-fda
+
+    @author Erick Fernandez de Arteaga
+	@version 0.0.0
+	@file
+	
+	@see Pixel
+	@see Pixel.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "Pixel.h"
+#include <random>
+#include <vector>
+
+/*----------------------------------------------------------------------------------------
+	Class Fields
+----------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Returns a cl_float4 with random RGBA values;
+*/
+cl_float4 Pixel::MakeRandomPixel()
+{
+	return cl_float4{Random0to1(), Random0to1(), Random0to1(), Random0to1()};
+}
+
+/**
+	Returns a random float value in the range [0-1].
+*/
+float Pixel::Random0to1()
+{
+	return ((float)rand() / RAND_MAX);
+}
+
+/**
+	Simulates halving the screen brightness by halving each cl_float4.	
+*/
+void Pixel::HalveBrightness(std::vector<cl_float4>& pixels, std::vector<cl_float4>& resultPixels)
+{
+	resultPixels = std::vector<cl_float4>();
+
+	for (const cl_float4& eachPixel : pixels)
+	{
+		float x = eachPixel.x / 2;
+		float y = eachPixel.y / 2;
+		float z = eachPixel.z / 2;
+		float w = eachPixel.w / 2;
+		cl_float4 half = {x, y, z, w};
+
+		resultPixels.push_back(half);
+	}
+}
+
+/**
+	Gets the average color from a vector of pixels.
+*/
+cl_float4 Pixel::GetAverageColor(std::vector<cl_float4> pixels)
+{
+	cl_float4 total { 0, 0, 0, 0 };
+	cl_float4 average { 0, 0, 0, 0 };
+
+	for (const cl_float4& eachPixel : pixels)
+	{
+		total.x += eachPixel.x;
+		total.y += eachPixel.y;
+		total.z += eachPixel.z;
+		total.w += eachPixel.w;
+	}
+
+	average.x = total.x / pixels.size();
+	average.y = total.y / pixels.size();
+	average.z = total.z / pixels.size();
+	average.w = total.w / pixels.size();
+
+	return average;
+}
+
+/**
+	Returns the pixel at the given index of the random image with the given seed, with 
+	RGBA values in the range [0-1). Each pixel depends only on the seed and its index, 
+	so an image comes out the same however it is split between threads.
+*/
+cl_float4 Pixel::MakeRandomPixel(uint32_t seed, uint64_t index)
+{
+	uint64_t key = MixBits(seed) + index * 2;
+	uint64_t first = MixBits(key);
+	uint64_t second = MixBits(key + 1);
+	const float scale = 1.0f / 16777216.0f;
+
+	/* Two 24-bit fields from each 64-bit value, each filling a float's mantissa. */
+	return cl_float4{ 
+		(first >> 40) * scale, ((first >> 16) & 0xFFFFFF) * scale, 
+		(second >> 40) * scale, ((second >> 16) & 0xFFFFFF) * scale };
+}
+
+/**
+	Gets the average color of pixels without copying them. Each block of pixels is 
+	summed in sixteen float lanes, which the compiler can vectorize, and the block sums 
+	are added in double so large images do not lose precision.
+*/
+cl_float4 Pixel::GetAverageColor(const cl_float4* pixels, size_t numPixels)
+{
+	const size_t blockPixels = 4096;
+	const float* values = reinterpret_cast<const float*>(pixels);
+	double total[4] = { 0, 0, 0, 0 };
+
+	for (size_t blockStart = 0; blockStart < numPixels; blockStart += blockPixels)
+	{
+		size_t blockEnd = (numPixels - blockStart < blockPixels) ? numPixels : blockStart + blockPixels;
+		float lanes[16] = {};
+		size_t i = blockStart;
+
+		/* Four pixels at a time, so lane k always holds channel k % 4. */
+		for (; i + 4 <= blockEnd; i += 4)
+		{
+			for (int lane = 0; lane < 16; lane++)
+			{
+				lanes[lane] += values[i * 4 + lane];
+			}
+		}
+		for (; i < blockEnd; i++)
+		{
+			for (int channel = 0; channel < 4; channel++)
+			{
+				lanes[channel] += values[i * 4 + channel];
+			}
+		}
+
+		for (int channel = 0; channel < 4; channel++)
+		{
+			total[channel] += (double)lanes[channel] + lanes[channel + 4] + lanes[channel + 8] + lanes[channel + 12];
+		}
+	}
+
+	cl_float4 average { 0, 0, 0, 0 };
+
+	if (numPixels > 0)
+	{
+		average.x = (float)(total[0] / numPixels);
+		average.y = (float)(total[1] / numPixels);
+		average.z = (float)(total[2] / numPixels);
+		average.w = (float)(total[3] / numPixels);
+	}
+
+	return average;
+}
+
+/**
+	Halves each pixel into resultPixels, which must already hold numPixels. Gives the 
+	same results as the vector overload without growing a vector one pixel at a time, 
+	and the flat loop over floats vectorizes.
+*/
+void Pixel::HalveBrightness(const cl_float4* pixels, cl_float4* resultPixels, size_t numPixels)
+{
+	const float* values = reinterpret_cast<const float*>(pixels);
+	float* results = reinterpret_cast<float*>(resultPixels);
+
+	for (size_t i = 0; i < numPixels * 4; i++)
+	{
+		results[i] = values[i] * 0.5f;
+	}
+}
+
+/**
+	Scrambles the bits of a value with the SplitMix64 finalizer, so that neighbouring 
+	inputs give unrelated outputs.
+*/
+uint64_t Pixel::MixBits(uint64_t value)
+{
+	value += 0x9E3779B97F4A7C15ULL;
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+	return value ^ (value >> 31);
+}
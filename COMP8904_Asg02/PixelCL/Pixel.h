@@ -22,6 +22,8 @@
 /*========================================================================================
 	Dependencies
 ========================================================================================*/
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <CL/cl.h>
 
@@ -46,7 +48,7 @@ struct float4
 	@see Pixel
 	@see Pixel.cpp
 */
-static class Pixel
+class Pixel
 {
     /*------------------------------------------------------------------------------------
 		Class Fields
@@ -61,8 +63,13 @@ static class Pixel
 		static cl_float4 GetAverageColor(std::vector<cl_float4> pixels);
 		static void HalveBrightness(std::vector<cl_float4>& pixels, std::vector<cl_float4>& resultPixels);
 
+		static cl_float4 MakeRandomPixel(uint32_t seed, uint64_t index);
+		static cl_float4 GetAverageColor(const cl_float4* pixels, size_t numPixels);
+		static void HalveBrightness(const cl_float4* pixels, cl_float4* resultPixels, size_t numPixels);
+
     private:
 		static float Random0to1();
+		static uint64_t MixBits(uint64_t value);
 
 };
 
@@ -0,0 +1,224 @@
+/*===================================================================================*//**
+	PixelBatch
+	
+	Packs many small images into one buffer so they can be processed with a single 
+	kernel launch.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see PixelBatch
+	@see PixelBatch.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "PixelBatch.h"
+#include <algorithm>
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Appends an image to the batch and returns its index. Each of its pixels will be 
+	multiplied by the given scale.
+*/
+size_t PixelBatch::AddImage(const cl_float4* pixels, size_t numPixels, float scale)
+{
+	ImageParams image;
+	image.offset = (cl_uint)_pixels.size();
+	image.numPixels = (cl_uint)numPixels;
+	image.scale = scale;
+	image.padding = 0;
+
+	_images.push_back(image);
+	_pixels.insert(_pixels.end(), pixels, pixels + numPixels);
+
+	return _images.size() - 1;
+}
+
+/**
+	Removes all images, keeping the allocated storage for the next batch.
+*/
+void PixelBatch::Clear()
+{
+	_pixels.clear();
+	_images.clear();
+}
+
+/**
+	Returns the number of images in the batch.
+*/
+size_t PixelBatch::GetImageCount() const
+{
+	return _images.size();
+}
+
+/**
+	Returns the total number of pixels across all images in the batch.
+*/
+size_t PixelBatch::GetPixelCount() const
+{
+	return _pixels.size();
+}
+
+/**
+	Returns the packed pixels of every image.
+*/
+const std::vector<cl_float4>& PixelBatch::GetPixels() const
+{
+	return _pixels;
+}
+
+/**
+	Returns the offset table and per-image parameters.
+*/
+const std::vector<ImageParams>& PixelBatch::GetImages() const
+{
+	return _images;
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Returns how many image parameter entries fit in the device's constant memory.
+*/
+size_t PixelBatch::GetMaxImagesPerLaunch(cl_device_id device)
+{
+	cl_ulong constantBufferSize = 0;
+	clGetDeviceInfo(device, CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE, sizeof(cl_ulong), &constantBufferSize, nullptr);
+
+	/* The spec guarantees at least 64 KB. */
+	if (constantBufferSize == 0)
+	{
+		constantBufferSize = 64 * 1024;
+	}
+
+	return (size_t)(constantBufferSize / sizeof(ImageParams));
+}
+
+/**
+	Runs the scaleBrightnessBatched kernel over every image in the batch.
+	
+	All pixels are uploaded and read back with one transfer each. The images are 
+	launched in as few NDRanges as the constant memory allows, normally just one. Each 
+	launch uses a global offset so the kernel can find its image from the offset table. 
+	Device buffers come from the arena and are given back afterwards, so batches of 
+	similar size reuse the same memory. Returns the first OpenCL error hit, or CL_SUCCESS.
+*/
+cl_int PixelBatch::Execute(
+	DeviceArena& arena, cl_command_queue commandQueue, cl_kernel kernel, 
+	const PixelBatch& batch, 
+	size_t localSize, size_t maxImagesPerLaunch, 
+	std::vector<cl_float4>& resultPixels)
+{
+	cl_int result = 0;
+	size_t numPixels = batch.GetPixelCount();
+	size_t numImages = batch.GetImageCount();
+	resultPixels.resize(numPixels);
+
+	if (numPixels == 0)
+	{
+		return CL_SUCCESS;
+	}
+
+	size_t bufferSize = sizeof(cl_float4) * numPixels;
+	size_t imagesPerLaunch = std::min(numImages, maxImagesPerLaunch);
+
+	cl_mem clStartPixels = arena.Allocate(bufferSize, &result);
+	cl_mem clResultPixels = nullptr;
+	cl_mem clImages = nullptr;
+
+	if (result == CL_SUCCESS)
+	{
+		clResultPixels = arena.Allocate(bufferSize, &result);
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		clImages = arena.Allocate(sizeof(ImageParams) * imagesPerLaunch, &result);
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		result = clEnqueueWriteBuffer(
+			commandQueue, clStartPixels,
+			CL_FALSE, 0,
+			bufferSize, batch.GetPixels().data(),
+			0, NULL,
+			NULL
+		);
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		result = clSetKernelArg(kernel, 0, sizeof(cl_mem), &clStartPixels);
+		result |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &clResultPixels);
+		result |= clSetKernelArg(kernel, 2, sizeof(cl_mem), &clImages);
+	}
+
+	/* Launch the images in chunks that fit in constant memory. */
+	const std::vector<ImageParams>& images = batch.GetImages();
+	for (size_t firstImage = 0; firstImage < numImages && result == CL_SUCCESS; firstImage += imagesPerLaunch)
+	{
+		cl_uint chunkImages = (cl_uint)std::min(imagesPerLaunch, numImages - firstImage);
+		cl_uint firstPixel = images[firstImage].offset;
+		cl_uint endPixel = (firstImage + chunkImages < numImages) ? 
+			images[firstImage + chunkImages].offset : (cl_uint)numPixels;
+
+		if (endPixel == firstPixel)
+		{
+			continue;
+		}
+
+		/* The in-order queue keeps this write from overtaking the previous launch. */
+		result = clEnqueueWriteBuffer(
+			commandQueue, clImages,
+			CL_FALSE, 0,
+			sizeof(ImageParams) * chunkImages, &images[firstImage],
+			0, NULL,
+			NULL
+		);
+
+		result |= clSetKernelArg(kernel, 3, sizeof(cl_uint), &chunkImages);
+		result |= clSetKernelArg(kernel, 4, sizeof(cl_uint), &endPixel);
+
+		if (result != CL_SUCCESS)
+		{
+			break;
+		}
+
+		size_t globalOffset = firstPixel;
+		size_t globalSize = ((endPixel - firstPixel + localSize - 1) / localSize) * localSize;
+		result = clEnqueueNDRangeKernel(
+			commandQueue, kernel,
+			1, &globalOffset,
+			&globalSize, &localSize,
+			0, NULL,
+			NULL
+		);
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		result = clEnqueueReadBuffer(
+			commandQueue, clResultPixels,
+			CL_TRUE, 0,
+			bufferSize, resultPixels.data(),
+			0, NULL,
+			NULL
+		);
+	}
+
+	/* Make sure nothing still uses the regions before giving them back. */
+	clFinish(commandQueue);
+	arena.Free(clStartPixels);
+	arena.Free(clResultPixels);
+	arena.Free(clImages);
+
+	return result;
+}
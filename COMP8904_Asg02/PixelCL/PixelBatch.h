@@ -0,0 +1,84 @@
+/*===================================================================================*//**
+	PixelBatch
+	
+	Packs many small images into one buffer so they can be processed with a single 
+	kernel launch.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see PixelBatch
+	@see PixelBatch.cpp
+	
+*//*====================================================================================*/
+
+#ifndef PIXEL_BATCH_H
+#define PIXEL_BATCH_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include <vector>
+#include <CL/cl.h>
+#include "DeviceArena.h"
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	Per-image parameters read by the scaleBrightnessBatched kernel from constant memory.
+	
+	Must match the layout of ImageParams in Kernel.cl.
+*/
+struct ImageParams
+{
+	public:
+		cl_uint offset;
+		cl_uint numPixels;
+		cl_float scale;
+		cl_uint padding;
+};
+
+/*========================================================================================
+	PixelBatch	
+========================================================================================*/
+/**
+	A set of images packed back to back, with a table of where each image starts.
+	
+	@see PixelBatch.cpp
+*/
+class PixelBatch
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::vector<cl_float4> _pixels;
+		std::vector<ImageParams> _images;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		size_t AddImage(const cl_float4* pixels, size_t numPixels, float scale);
+		void Clear();
+		size_t GetImageCount() const;
+		size_t GetPixelCount() const;
+		const std::vector<cl_float4>& GetPixels() const;
+		const std::vector<ImageParams>& GetImages() const;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static size_t GetMaxImagesPerLaunch(cl_device_id device);
+		static cl_int Execute(
+			DeviceArena& arena, cl_command_queue commandQueue, cl_kernel kernel, 
+			const PixelBatch& batch, 
+			size_t localSize, size_t maxImagesPerLaunch, 
+			std::vector<cl_float4>& resultPixels);
+};
+
+#endif
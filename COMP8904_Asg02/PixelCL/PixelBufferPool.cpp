@@ -0,0 +1,315 @@
+/*===================================================================================*//**
+	PixelBufferPool
+	
+	Pool of page-aligned host pixel buffers, optionally backed by huge pages, that are 
+	recycled between batches instead of being allocated and thrown away each time.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see PixelBufferPool
+	@see PixelBufferPool.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "PixelBufferPool.h"
+#include <algorithm>
+#include <iterator>
+#include <new>
+
+#if defined(_WIN32)
+	#define NOMINMAX
+	#include <windows.h>
+#elif defined(__linux__)
+	#include <cstdint>
+	#include <sys/mman.h>
+#endif
+
+/*----------------------------------------------------------------------------------------
+	Constants
+----------------------------------------------------------------------------------------*/
+/** How a block was allocated, so it can be freed the same way. */
+const int BLOCK_ALIGNED_NEW = 0;
+const int BLOCK_MMAP = 1;
+const int BLOCK_VIRTUAL_ALLOC = 2;
+
+/** Default cap on memory kept in the free lists. */
+const size_t DEFAULT_MAX_CACHED_BYTES = (size_t)1024 * 1024 * 1024;
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates an empty pool of 4 KB aligned buffers without huge pages.
+*/
+PixelBufferPool::PixelBufferPool()
+	: _alignment(SMALL_PAGE_SIZE), 
+	_useHugePages(false), 
+	_maxCachedBytes(DEFAULT_MAX_CACHED_BYTES), 
+	_statistics()
+{
+}
+
+/**
+	Frees every block, including any that were never released.
+*/
+PixelBufferPool::~PixelBufferPool()
+{
+	Trim();
+
+	for (std::pair<void* const, PoolBlock>& eachBlock : _inUse)
+	{
+		FreeBlock(eachBlock.second);
+	}
+}
+
+/**
+	Chooses whether new buffers are 2 MB aligned and backed by huge pages, and how much 
+	released memory is kept for reuse. Buffers already handed out are not affected.
+*/
+void PixelBufferPool::Configure(bool useHugePages, size_t maxCachedBytes)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_useHugePages = useHugePages;
+	_alignment = useHugePages ? HUGE_PAGE_SIZE : SMALL_PAGE_SIZE;
+	_maxCachedBytes = maxCachedBytes;
+}
+
+/**
+	Returns a buffer for at least numPixels pixels. A cached buffer is reused if it is 
+	no more than twice the size needed; otherwise a new one is allocated. Returns nullptr 
+	on failure.
+*/
+cl_float4* PixelBufferPool::Acquire(size_t numPixels)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	size_t bytes = numPixels * sizeof(cl_float4);
+	bytes = ((bytes + _alignment - 1) / _alignment) * _alignment;
+
+	if (bytes == 0)
+	{
+		bytes = _alignment;
+	}
+
+	std::multimap<size_t, PoolBlock>::iterator cached = _free.lower_bound(bytes);
+
+	if (cached != _free.end() && cached->first <= 2 * bytes && cached->second.alignment >= _alignment)
+	{
+		PoolBlock block = cached->second;
+		_free.erase(cached);
+		_inUse[block.pointer] = block;
+		_statistics.reuses++;
+		_statistics.bytesCached -= block.capacity;
+		_statistics.bytesInUse += block.capacity;
+		_statistics.peakBytesInUse = std::max(_statistics.peakBytesInUse, _statistics.bytesInUse);
+		return (cl_float4*)block.pointer;
+	}
+
+	PoolBlock block = AllocateBlock(bytes, _alignment, _useHugePages);
+
+	if (!block.pointer)
+	{
+		return nullptr;
+	}
+
+	_inUse[block.pointer] = block;
+	_statistics.allocations++;
+	_statistics.bytesInUse += block.capacity;
+	_statistics.peakBytesInUse = std::max(_statistics.peakBytesInUse, _statistics.bytesInUse);
+
+	if (block.hugePages)
+	{
+		_statistics.hugePageBytes += block.capacity;
+	}
+
+	return (cl_float4*)block.pointer;
+}
+
+/**
+	Returns a buffer to the pool. The largest cached blocks are freed while the cache is 
+	over its limit. Pointers the pool does not own are ignored.
+*/
+void PixelBufferPool::Release(cl_float4* pixels)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::unordered_map<void*, PoolBlock>::iterator found = _inUse.find(pixels);
+
+	if (found == _inUse.end())
+	{
+		return;
+	}
+
+	PoolBlock block = found->second;
+	_inUse.erase(found);
+	_statistics.bytesInUse -= block.capacity;
+	_statistics.bytesCached += block.capacity;
+	_free.insert(std::make_pair(block.capacity, block));
+
+	while (_statistics.bytesCached > _maxCachedBytes && !_free.empty())
+	{
+		std::multimap<size_t, PoolBlock>::iterator largest = std::prev(_free.end());
+		_statistics.bytesCached -= largest->second.capacity;
+
+		if (largest->second.hugePages)
+		{
+			_statistics.hugePageBytes -= largest->second.capacity;
+		}
+
+		FreeBlock(largest->second);
+		_free.erase(largest);
+	}
+}
+
+/**
+	Frees every cached block. Buffers still in use are kept.
+*/
+void PixelBufferPool::Trim()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for (std::pair<const size_t, PoolBlock>& eachBlock : _free)
+	{
+		if (eachBlock.second.hugePages)
+		{
+			_statistics.hugePageBytes -= eachBlock.second.capacity;
+		}
+
+		FreeBlock(eachBlock.second);
+	}
+
+	_free.clear();
+	_statistics.bytesCached = 0;
+}
+
+/**
+	Returns a snapshot of the pool's counters.
+*/
+PoolStatistics PixelBufferPool::GetStatistics()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _statistics;
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Allocates an aligned block without touching its pages. Huge pages are tried first 
+	if asked for: MAP_HUGETLB on Linux and MEM_LARGE_PAGES on Windows. Both need setup 
+	by the administrator (reserved huge pages, or the Lock Pages in Memory privilege), 
+	so on failure this falls back to ordinary pages. On Linux the fallback is still 2 MB 
+	aligned and advised for transparent huge pages.
+*/
+PoolBlock PixelBufferPool::AllocateBlock(size_t bytes, size_t alignment, bool useHugePages)
+{
+	PoolBlock block = { nullptr, bytes, alignment, BLOCK_ALIGNED_NEW, false };
+
+#if defined(_WIN32)
+	if (useHugePages)
+	{
+		SIZE_T largePage = GetLargePageMinimum();
+
+		if (largePage > 0)
+		{
+			SIZE_T largeBytes = ((bytes + largePage - 1) / largePage) * largePage;
+			block.pointer = VirtualAlloc(nullptr, largeBytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+
+			if (block.pointer)
+			{
+				block.capacity = largeBytes;
+				block.kind = BLOCK_VIRTUAL_ALLOC;
+				block.hugePages = true;
+				return block;
+			}
+		}
+	}
+
+	/* VirtualAlloc is 64 KB aligned, which covers the 4 KB case. */
+	if (alignment <= SMALL_PAGE_SIZE)
+	{
+		block.pointer = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		block.kind = BLOCK_VIRTUAL_ALLOC;
+		return block;
+	}
+#elif defined(__linux__)
+	#ifdef MAP_HUGETLB
+	if (useHugePages)
+	{
+		void* pointer = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+		if (pointer != MAP_FAILED)
+		{
+			block.pointer = pointer;
+			block.kind = BLOCK_MMAP;
+			block.hugePages = true;
+			return block;
+		}
+	}
+	#endif
+
+	/* Map extra so the block can be aligned, then unmap the unused head and tail. */
+	size_t mappedBytes = bytes + alignment;
+	void* mapped = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (mapped != MAP_FAILED)
+	{
+		uintptr_t start = (uintptr_t)mapped;
+		uintptr_t aligned = ((start + alignment - 1) / alignment) * alignment;
+		size_t head = aligned - start;
+		size_t tail = mappedBytes - head - bytes;
+
+		if (head > 0)
+		{
+			munmap(mapped, head);
+		}
+
+		if (tail > 0)
+		{
+			munmap((char*)aligned + bytes, tail);
+		}
+
+		block.pointer = (void*)aligned;
+		block.kind = BLOCK_MMAP;
+
+	#ifdef MADV_HUGEPAGE
+		if (useHugePages)
+		{
+			madvise(block.pointer, bytes, MADV_HUGEPAGE);
+		}
+	#endif
+
+		return block;
+	}
+#endif
+
+	(void)useHugePages;
+	block.pointer = ::operator new(bytes, std::align_val_t(alignment), std::nothrow);
+	block.kind = BLOCK_ALIGNED_NEW;
+	return block;
+}
+
+/**
+	Frees a block the same way it was allocated.
+*/
+void PixelBufferPool::FreeBlock(const PoolBlock& block)
+{
+	switch (block.kind)
+	{
+#if defined(_WIN32)
+		case BLOCK_VIRTUAL_ALLOC:
+			VirtualFree(block.pointer, 0, MEM_RELEASE);
+			break;
+#elif defined(__linux__)
+		case BLOCK_MMAP:
+			munmap(block.pointer, block.capacity);
+			break;
+#endif
+		default:
+			::operator delete(block.pointer, std::align_val_t(block.alignment));
+			break;
+	}
+}
@@ -0,0 +1,117 @@
+/*===================================================================================*//**
+	PixelBufferPool
+	
+	Pool of page-aligned host pixel buffers, optionally backed by huge pages, that are 
+	recycled between batches instead of being allocated and thrown away each time.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see PixelBufferPool
+	@see PixelBufferPool.cpp
+	
+*//*====================================================================================*/
+
+#ifndef PIXEL_BUFFER_POOL_H
+#define PIXEL_BUFFER_POOL_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <CL/cl.h>
+
+/*========================================================================================
+	Constants
+========================================================================================*/
+/** Alignment for ordinary pages, which is enough for CL_MEM_USE_HOST_PTR. */
+const size_t SMALL_PAGE_SIZE = 4096;
+
+/** Alignment and size granularity for huge pages. */
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	A block of memory owned by the pool.
+*/
+struct PoolBlock
+{
+	public:
+		void* pointer;
+		size_t capacity;
+		size_t alignment;
+		int kind;
+		bool hugePages;
+};
+
+/**
+	Counters describing how the pool has been used.
+*/
+struct PoolStatistics
+{
+	public:
+		size_t allocations;
+		size_t reuses;
+		size_t bytesInUse;
+		size_t peakBytesInUse;
+		size_t bytesCached;
+		size_t hugePageBytes;
+};
+
+/*========================================================================================
+	PixelBufferPool	
+========================================================================================*/
+/**
+	Thread-safe pool of aligned host pixel buffers.
+	
+	Each buffer's capacity is rounded up to the alignment, so it is a valid 
+	CL_MEM_USE_HOST_PTR region. Fresh buffers are not touched, so their pages can still 
+	be placed by NumaAllocator. Released buffers are cached and handed back out for later 
+	requests of a similar size.
+	
+	@see PixelBufferPool.cpp
+*/
+class PixelBufferPool
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::mutex _mutex;
+		size_t _alignment;
+		bool _useHugePages;
+		size_t _maxCachedBytes;
+		std::multimap<size_t, PoolBlock> _free;
+		std::unordered_map<void*, PoolBlock> _inUse;
+		PoolStatistics _statistics;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		PixelBufferPool();
+		~PixelBufferPool();
+		PixelBufferPool(const PixelBufferPool&) = delete;
+		PixelBufferPool& operator=(const PixelBufferPool&) = delete;
+
+		void Configure(bool useHugePages, size_t maxCachedBytes);
+		cl_float4* Acquire(size_t numPixels);
+		void Release(cl_float4* pixels);
+		void Trim();
+		PoolStatistics GetStatistics();
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    private:
+		static PoolBlock AllocateBlock(size_t bytes, size_t alignment, bool useHugePages);
+		static void FreeBlock(const PoolBlock& block);
+};
+
+#endif
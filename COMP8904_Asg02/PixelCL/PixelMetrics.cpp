@@ -0,0 +1,88 @@
+/*===================================================================================*//**
+	PixelMetrics
+	
+	The metrics the pixel pipeline keeps while it runs.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see PixelMetrics
+	@see PixelMetrics.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "PixelMetrics.h"
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Looks up the pipeline's metrics, registering them the first time.
+*/
+PixelMetrics::PixelMetrics() :
+	framesProcessed(Metrics::GetCounter("pixelcl_frames_total", "Frames run through a pixel kernel.")), 
+	pixelsProcessed(Metrics::GetCounter("pixelcl_pixels_total", "Pixels run through a pixel kernel.")), 
+	pixelsPerSecond(Metrics::GetGauge("pixelcl_pixels_per_second", "Pixel throughput of the most recent frame or batch.")), 
+	bytesUploaded(Metrics::GetCounter("pixelcl_upload_bytes_total", "Bytes written from host to device.")), 
+	bytesDownloaded(Metrics::GetCounter("pixelcl_download_bytes_total", "Bytes read from device to host.")), 
+	kernelSeconds(Metrics::GetHistogram("pixelcl_kernel_seconds", "Pixel kernel latency, from enqueue to completion.")), 
+	uploadSeconds(Metrics::GetHistogram("pixelcl_upload_seconds", "Blocking host to device write latency.")), 
+	downloadSeconds(Metrics::GetHistogram("pixelcl_download_seconds", "Blocking device to host read latency.")), 
+	hostPoolReuses(Metrics::GetGauge("pixelcl_host_pool_reuses", "Host buffers handed out again by the pixel buffer pool.")), 
+	deviceArenaReuses(Metrics::GetGauge("pixelcl_device_arena_reuses", "Device regions handed out again by the device arena.")), 
+	peakHostBytes(Metrics::GetGauge("pixelcl_host_bytes_peak", "Most host buffer memory in use at once.")), 
+	peakDeviceBytes(Metrics::GetGauge("pixelcl_device_bytes_peak", "Most device arena memory in use at once."))
+{
+}
+
+/**
+	Counts frames and their pixels, and sets the throughput from how long they took.
+*/
+void PixelMetrics::AddFrames(size_t frames, size_t pixels, double seconds)
+{
+	framesProcessed.Add(frames);
+	pixelsProcessed.Add(pixels);
+
+	if (seconds > 0)
+	{
+		pixelsPerSecond.Set(pixels / seconds);
+	}
+}
+
+/**
+	Counts a blocking write to a device and records how long it took.
+*/
+void PixelMetrics::AddUpload(size_t bytes, double seconds)
+{
+	bytesUploaded.Add(bytes);
+	uploadSeconds.RecordSeconds(seconds);
+}
+
+/**
+	Counts a blocking read from a device and records how long it took.
+*/
+void PixelMetrics::AddDownload(size_t bytes, double seconds)
+{
+	bytesDownloaded.Add(bytes);
+	downloadSeconds.RecordSeconds(seconds);
+}
+
+/**
+	Copies the buffer pool's and device arena's reuse counts, and raises the peaks to 
+	the highest use each has recorded. Both take their own locks, so this is not for 
+	the hot path.
+*/
+void PixelMetrics::UpdateMemory(PixelBufferPool& pool, DeviceArena& arena)
+{
+	PoolStatistics poolStatistics = pool.GetStatistics();
+	ArenaStatistics arenaStatistics = arena.GetStatistics();
+
+	hostPoolReuses.Set((double)poolStatistics.reuses);
+	deviceArenaReuses.Set((double)arenaStatistics.reuses);
+	peakHostBytes.SetMax((double)poolStatistics.peakBytesInUse);
+	peakDeviceBytes.SetMax((double)arenaStatistics.peakBytesInUse);
+}
@@ -0,0 +1,65 @@
+/*===================================================================================*//**
+	PixelMetrics
+	
+	The metrics the pixel pipeline keeps while it runs.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see PixelMetrics
+	@see PixelMetrics.cpp
+	
+*//*====================================================================================*/
+
+#ifndef PIXEL_METRICS_H
+#define PIXEL_METRICS_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include "DeviceArena.h"
+#include "Metrics.h"
+#include "PixelBufferPool.h"
+
+/*========================================================================================
+	PixelMetrics	
+========================================================================================*/
+/**
+	References to the pipeline's metrics, looked up once so that updating them is only 
+	an atomic add. Every PixelMetrics refers to the same process-wide metrics.
+	
+	@see PixelMetrics.cpp
+*/
+class PixelMetrics
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    public:
+		MetricCounter& framesProcessed;
+		MetricCounter& pixelsProcessed;
+		MetricGauge& pixelsPerSecond;
+		MetricCounter& bytesUploaded;
+		MetricCounter& bytesDownloaded;
+		MetricHistogram& kernelSeconds;
+		MetricHistogram& uploadSeconds;
+		MetricHistogram& downloadSeconds;
+		MetricGauge& hostPoolReuses;
+		MetricGauge& deviceArenaReuses;
+		MetricGauge& peakHostBytes;
+		MetricGauge& peakDeviceBytes;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		PixelMetrics();
+		void AddFrames(size_t frames, size_t pixels, double seconds);
+		void AddUpload(size_t bytes, double seconds);
+		void AddDownload(size_t bytes, double seconds);
+		void UpdateMemory(PixelBufferPool& pool, DeviceArena& arena);
+};
+
+#endif
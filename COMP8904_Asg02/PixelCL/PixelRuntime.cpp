@@ -0,0 +1,1962 @@
+/*===================================================================================*//**
+	PixelRuntime
+	
+	Device discovery, context, program and buffer management, execution and timing 
+	shared by the OpenCL parts.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see PixelRuntime
+	@see PixelRuntime.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "PixelRuntime.h"
+#include "AsyncSubmission.h"
+#include "ClError.h"
+#include "CommandGraph.h"
+#include "CommandLine.h"
+#include "DeviceFission.h"
+#include "Pixel.h"
+#include "PixelBatch.h"
+#include "PixelStream.h"
+#include "SharedVirtualMemory.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+/*========================================================================================
+	Constants
+========================================================================================*/
+/** halveBrightness reads and writes one float4 per pixel and does one multiply per channel. */
+const double HALVE_BYTES_PER_PIXEL = 2 * sizeof(cl_float4);
+const double HALVE_FLOPS_PER_PIXEL = 4;
+
+/** The kernel the serial run matches. Other --kernel choices are not checked against it. */
+const char* const SERIAL_KERNEL_NAME = "halveBrightness";
+
+/** computeColorStatistics reads one float4 per pixel and does eight FLOPs per channel. */
+const double STATISTICS_BYTES_PER_PIXEL = sizeof(cl_float4);
+const double STATISTICS_FLOPS_PER_PIXEL = 4 * 8;
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates a runtime with no pixels or devices.
+*/
+PixelRuntime::PixelRuntime() :
+	_startPixelHostBuffer(nullptr),
+	_resultPixelHostBuffer(nullptr),
+	_numaPolicy(NUMA_PARTITION),
+	_hostRoofline(),
+	_deviceRoofline(),
+	_isMeasuringPeaks(false),
+	_isSetUp(false),
+	_setUpSeconds(0),
+	_isFirstFrameDone(false),
+	_queueDevice(nullptr),
+	_isOutOfOrder(false),
+	_kernelFilePath(""),
+	_tracePath(""),
+	_kernelString(""),
+	_maxImagesPerLaunch(0),
+	_bufferSize(0),
+	_clStartPixels(nullptr),
+	_clResultPixels(nullptr)
+{
+}
+
+/**
+	Releases the device buffers, OpenCL objects and host buffers, including after a 
+	failed setup.
+*/
+PixelRuntime::~PixelRuntime()
+{
+	CleanUpCl();
+}
+
+/**
+	Reads the problem size and launch settings, and prints them. The kernel source is 
+	read from --kernel-file or PIXELCL_KERNEL_FILE if one is given. A Chrome trace of 
+	the run is recorded to --trace or PIXELCL_TRACE_FILE if the library was built with 
+	PIXELCL_TRACE, and metrics are exported as StartMetrics describes. Hardware counters 
+	are read for the host regions when --perf-counters or PIXELCL_PERF_COUNTERS is given 
+	and the kernel allows it. The workload is recorded to --capture or PIXELCL_CAPTURE if 
+	one is given.
+*/
+bool PixelRuntime::Configure(int argc, char* argv[])
+{
+	/* Loads --config and --replay, so every option read below can come from them too. */
+	std::string configError;
+	if (!_config.Load(argc, argv, configError))
+	{
+		std::cout << "ERROR: " << configError << "\n\n";
+		return false;
+	}
+
+	_kernelFilePath = CommandLine::GetOption(argc, argv, "--kernel-file", "PIXELCL_KERNEL_FILE");
+	_tracePath = CommandLine::GetOption(argc, argv, "--trace", "PIXELCL_TRACE_FILE");
+	_isMeasuringPeaks = CommandLine::HasFlag(argc, argv, "--measure-peaks", "PIXELCL_MEASURE_PEAKS");
+
+	if (!StartMetrics(argc, argv))
+	{
+		return false;
+	}
+
+	if (!_tracePath.empty() && !Trace::Start(_tracePath))
+	{
+		std::cout << "Tracing is not built in. Rebuild with PIXELCL_TRACE defined to use --trace.\n\n";
+		_tracePath = "";
+	}
+
+	if (CommandLine::HasFlag(argc, argv, "--perf-counters", "PIXELCL_PERF_COUNTERS") && !_perfCounters.Open())
+	{
+		std::cout << "Running without hardware counters: " << _perfCounters.GetError() << ".\n\n";
+	}
+
+	_config.Print(std::cout);
+	_startTime = std::chrono::steady_clock::now();
+
+	_capture.Start(CommandLine::GetOption(argc, argv, "--capture", "PIXELCL_CAPTURE"));
+
+	if (_capture.IsCapturing())
+	{
+		_capture.Set("pixels", std::to_string(_config.numPixels));
+		_capture.Set("kernel", _config.kernelName);
+		_capture.Set("kernel-file", _kernelFilePath);
+		_capture.Set("local-size", std::to_string(_config.localSize));
+		_capture.Set("iterations", std::to_string(_config.iterations));
+		_capture.Set("seed", std::to_string(_config.seed));
+		_capture.Set("build-options", _config.buildOptions);
+		std::cout << "Recording workload to " << _capture.GetPath() << ".\n\n";
+	}
+
+	return true;
+}
+
+/**
+	Generates pixels to use. The host buffers are spread across NUMA nodes by the policy 
+	given with --numa or PIXELCL_NUMA ("partition" or "interleave"). They come from the 
+	pixel buffer pool, backed by huge pages when --huge-pages or PIXELCL_HUGE_PAGES is 
+	given. They are filled in parallel by threads on the nodes that own each range, and 
+	the read bandwidth of each node is reported. The pixels depend only on the seed, so 
+	the same seed gives the same pixels whatever the NUMA layout.
+*/
+bool PixelRuntime::GeneratePixels(int argc, char* argv[])
+{
+	TraceSpan span("GeneratePixels");
+
+	/* Initialize fields. */
+	_startPixels = std::vector<cl_float4>();
+	_resultPixels = std::vector<cl_float4>();
+	_bufferSize = _config.GetBufferSize();
+	_numaPolicy = NumaAllocator::ParsePolicy(CommandLine::GetOption(argc, argv, "--numa", "PIXELCL_NUMA"));
+
+	bool useHugePages = CommandLine::HasFlag(argc, argv, "--huge-pages", "PIXELCL_HUGE_PAGES");
+	_capture.Set("numa", NumaAllocator::GetPolicyName(_numaPolicy));
+	_capture.Set("huge-pages", useHugePages ? "1" : "0");
+	_pixelBufferPool.Configure(useHugePages, (size_t)1024 * 1024 * 1024);
+
+	_startPixelHostBuffer = _pixelBufferPool.Acquire(_config.numPixels);
+	_resultPixelHostBuffer = _pixelBufferPool.Acquire(_config.numPixels);
+
+	if (!_startPixelHostBuffer || !_resultPixelHostBuffer)
+	{
+		std::cout << "Failed to allocate host buffers.\n\n";
+		return false;
+	}
+
+	/* Fresh pool buffers are untouched, so the NUMA policy can still place them. */
+	NumaAllocator::Bind(_startPixelHostBuffer, _bufferSize, _numaPolicy);
+	NumaAllocator::Bind(_resultPixelHostBuffer, _bufferSize, _numaPolicy);
+
+	if (useHugePages)
+	{
+		PoolStatistics statistics = _pixelBufferPool.GetStatistics();
+		std::cout << "Host buffers on huge pages: " << statistics.hugePageBytes / (1024 * 1024) << " MB of " << 
+			statistics.bytesInUse / (1024 * 1024) << " MB.\n\n";
+	}
+
+	/* Generate pixels from their indices, so the threads stay independent. */
+	std::cout << "Generating pixels with seed " << _config.seed << "...\n\n";
+	uint32_t seed = _config.seed;
+	cl_float4* startPixels = _startPixelHostBuffer;
+	cl_float4* resultPixels = _resultPixelHostBuffer;
+	NumaAllocator::ParallelInitialize(_config.numPixels, sizeof(cl_float4), _numaPolicy, [seed, startPixels, resultPixels](int, size_t first, size_t count)
+	{
+		for (size_t i = first; i < first + count; i++)
+		{
+			startPixels[i] = Pixel::MakeRandomPixel(seed, i);
+			resultPixels[i] = cl_float4();
+		}
+	});
+
+	/* Keep a copy for the serial run. */
+	_startPixels.assign(_startPixelHostBuffer, _startPixelHostBuffer + _config.numPixels);
+
+	/* Report how fast each node can read its share. This streams several times the 
+	last-level cache, so it only runs when asked for. */
+	if (_isMeasuringPeaks)
+	{
+		std::vector<double> bandwidth = NumaAllocator::MeasureNodeBandwidth(_startPixelHostBuffer, _bufferSize, _numaPolicy);
+		std::cout << "Host read bandwidth per NUMA node (" << NumaAllocator::GetPolicyName(_numaPolicy) << "):\n";
+		for (size_t node = 0; node < bandwidth.size(); node++)
+		{
+			std::cout << "\tNode " << node << ": " << bandwidth[node] << " GB/s\n";
+		}
+		std::cout << "\n";
+	}
+
+	return true;
+}
+
+/**
+	Halves the brightness of the pixels serially.
+*/
+void PixelRuntime::ExecuteSerially()
+{
+	TraceSpan span("ExecuteSerially");
+	RecordOperation("serial");
+
+	if (_isMeasuringPeaks && !_hostRoofline.IsMeasured())
+	{
+		_hostRoofline = Roofline::MeasureHost();
+		std::cout << "Measured host triad bandwidth of " << _hostRoofline.GetPeakGBs() << " GB/s.\n\n";
+	}
+
+	std::cout << "Executing serially. Timer start.\n\n";
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	PerfRegion perfRegion(_perfCounters, "HalveBrightness", std::cout);
+	Pixel::HalveBrightness(_startPixels, _resultPixels);
+	double seconds = GetSecondsSince(start);
+	std::cout << "Finished executing serially. Took " << (int)(seconds * 1000) << " ms.\n\n";
+	perfRegion.End();
+	_hostRoofline.Report(std::cout, HALVE_BYTES_PER_PIXEL * _config.numPixels, HALVE_FLOPS_PER_PIXEL * _config.numPixels, seconds);
+}
+
+/**
+	Discovers every OpenCL device and selects one device of each of the given types to 
+	run on. The first type is selected from any platform and the rest from the same 
+	platform, so that they can share one context. Devices are ranked by their 
+	capabilities, or by a quick bandwidth benchmark when --benchmark-devices or 
+	PIXELCL_BENCHMARK_DEVICES is given. The first choice can be overridden with --device 
+	or PIXELCL_DEVICE. Device profiles are loaded from --profile-dir or 
+	PIXELCL_PROFILE_DIR (the working directory by default), or measured and saved there 
+	first when --profile-devices or PIXELCL_PROFILE_DEVICES is given. The types and the 
+	first device's name are recorded, so a replay selects the same device.
+*/
+bool PixelRuntime::SelectDevices(int argc, char* argv[], const std::vector<cl_device_type>& types)
+{
+	return SelectDevices(argc, argv, types, std::cout);
+}
+
+/**
+	Selects devices as the other overload does, writing what it finds to the given 
+	stream so that it can run on a background thread.
+*/
+bool PixelRuntime::SelectDevices(int argc, char* argv[], const std::vector<cl_device_type>& types, std::ostream& stream)
+{
+	TraceSpan discoverSpan("Discover devices");
+	cl_int discoverResult = _deviceDatabase.Discover();
+	discoverSpan.End();
+
+	if (discoverResult != CL_SUCCESS || _deviceDatabase.GetDevices().empty())
+	{
+		stream << "ERROR: No OpenCL devices could be detected.\n\n";
+		return false;
+	}
+
+	std::string profileDirectory = CommandLine::GetOption(argc, argv, "--profile-dir", "PIXELCL_PROFILE_DIR");
+
+	if (CommandLine::HasFlag(argc, argv, "--profile-devices", "PIXELCL_PROFILE_DEVICES"))
+	{
+		stream << "Profiling devices...\n\n";
+		TraceSpan profileSpan("Profile devices");
+		_deviceDatabase.Profile(profileDirectory);
+	}
+	else
+	{
+		_deviceDatabase.LoadProfiles(profileDirectory);
+	}
+
+	if (CommandLine::HasFlag(argc, argv, "--benchmark-devices", "PIXELCL_BENCHMARK_DEVICES"))
+	{
+		DeviceScoreWeights weights;
+		weights.compute = 0;
+		weights.bandwidth = 1;
+
+		stream << "Benchmarking devices...\n\n";
+		TraceSpan benchmarkSpan("Benchmark devices");
+		_deviceDatabase.Benchmark();
+		_deviceDatabase.Score(weights);
+	}
+
+	_deviceDatabase.Print(stream);
+
+	_deviceTypes.clear();
+	_devices.clear();
+
+	std::string deviceOverride = _config.device;
+	std::vector<const DeviceInfo*> selected;
+	for (size_t i = 0; i < types.size(); i++)
+	{
+		std::string typeName = DeviceDatabase::GetTypeName(types[i]);
+		const DeviceInfo* info = (i == 0) ?
+			_deviceDatabase.Select(types[i], deviceOverride) :
+			_deviceDatabase.SelectOnPlatform(types[i], selected[0]->platform);
+
+		if (!info && i == 0)
+		{
+			stream << "ERROR: No " << typeName << (deviceOverride.empty() ? "" : " matching \"" + deviceOverride + "\"") << 
+				" could be detected on any available platform.\n\n";
+			return false;
+		}
+
+		/* Every device shares one context, so the rest must be on the first one's platform. */
+		if (!info)
+		{
+			stream << "ERROR: No " << typeName << " could be detected on the platform containing the " << 
+				DeviceDatabase::GetTypeName(types[0]) << ".\n\n";
+			return false;
+		}
+
+		selected.push_back(info);
+		_deviceTypes.push_back(types[i]);
+		_devices.push_back(info->device);
+	}
+
+	std::string typeNames = "";
+	for (cl_device_type eachType : types)
+	{
+		typeNames += (typeNames.empty() ? "" : " ") + DeviceDatabase::GetTypeName(eachType);
+	}
+	_capture.Set("device-types", typeNames);
+	_capture.Set("device", selected[0]->name);
+
+	/* Print out info on the selected devices. */
+	for (size_t i = 0; i < selected.size(); i++)
+	{
+		std::string typeName = DeviceDatabase::GetTypeName(types[i]);
+		stream << "Platform containing " << typeName << " is " << selected[i]->platformName << "\n";
+		stream << typeName << " is device " << selected[i]->name << "\n\n";
+	}
+
+	return true;
+}
+
+/**
+	Returns the selected device of the given type, or null if none was selected.
+*/
+cl_device_id PixelRuntime::GetDevice(cl_device_type type) const
+{
+	for (size_t i = 0; i < _deviceTypes.size(); i++)
+	{
+		if (_deviceTypes[i] == type)
+		{
+			return _devices[i];
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+	Starts selecting devices of the given types and building the program for those of 
+	contextTypes, in that order, on a background thread. The pixels can be generated 
+	meanwhile, so that start-up takes as long as the slower of the two rather than both. 
+	The thread's output is held back until FinishSetUp, which must be called before 
+	any device is used. With --serial-setup or PIXELCL_SERIAL_SETUP the set-up runs 
+	here instead, for comparison. It also runs here when devices are profiled or 
+	benchmarked, so that their measurements do not compete with pixel generation.
+*/
+void PixelRuntime::StartSetUp(
+	int argc, char* argv[], 
+	const std::vector<cl_device_type>& types, 
+	const std::vector<cl_device_type>& contextTypes)
+{
+	_isSetUp = false;
+	_setUpLog.str("");
+
+	bool measuresDevices = CommandLine::HasFlag(argc, argv, "--profile-devices", "PIXELCL_PROFILE_DEVICES") || 
+		CommandLine::HasFlag(argc, argv, "--benchmark-devices", "PIXELCL_BENCHMARK_DEVICES");
+
+	if (measuresDevices || CommandLine::HasFlag(argc, argv, "--serial-setup", "PIXELCL_SERIAL_SETUP"))
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		_isSetUp = RunSetUp(argc, argv, types, contextTypes, std::cout);
+		_setUpSeconds = GetSecondsSince(start);
+		return;
+	}
+
+	_setUpThread = std::thread([this, argc, argv, types, contextTypes]()
+	{
+		TraceSpan span("Background set-up");
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		_isSetUp = RunSetUp(argc, argv, types, contextTypes, _setUpLog);
+		_setUpSeconds = GetSecondsSince(start);
+	});
+}
+
+/**
+	Waits for the set-up started by StartSetUp, prints its output and how long it took, 
+	then creates the device buffers from the generated pixels.
+*/
+bool PixelRuntime::FinishSetUp()
+{
+	if (_setUpThread.joinable())
+	{
+		TraceSpan waitSpan("Wait for set-up");
+		std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+		_setUpThread.join();
+		double waitSeconds = GetSecondsSince(waitStart);
+
+		std::cout << _setUpLog.str();
+		_setUpLog.str("");
+		std::cout << "Set up devices in " << (int)(_setUpSeconds * 1000) << " ms on a background thread, waited " << 
+			(int)(waitSeconds * 1000) << " ms for it after loading.\n\n";
+	}
+	else
+	{
+		std::cout << "Set up devices in " << (int)(_setUpSeconds * 1000) << " ms before loading.\n\n";
+	}
+
+	if (!_isSetUp)
+	{
+		return false;
+	}
+
+	TraceSpan buffersSpan("CreateBuffers");
+	return CreateBuffers();
+}
+
+/**
+	Creates one context over the given devices, with the command queues on the first, 
+	then builds the program with the configured build options and creates the kernels 
+	and device buffers.
+*/
+bool PixelRuntime::SetUpCL(const std::vector<cl_device_id>& devices)
+{
+	TraceSpan setUpSpan("SetUpCL");
+	return BuildProgram(devices, std::cout) && CreateBuffers();
+}
+
+/**
+	Reads the kernel source and creates the context, command queues and device arena, 
+	then builds the program and creates the kernels. Nothing here needs the pixels, so 
+	it can run on a background thread while they are generated. Output goes to the 
+	given stream.
+*/
+bool PixelRuntime::BuildProgram(const std::vector<cl_device_id>& devices, std::ostream& stream)
+{
+	cl_int result = 0;
+
+	/* Read the kernel source. */
+	TraceSpan readSpan("ReadKernelFile");
+	bool readKernel = ReadKernelFile(stream);
+	readSpan.End();
+
+	if (!readKernel)
+	{
+		stream << "Failed to read kernel file.\n\n";
+		return false;
+	}
+
+	/* Record the devices' types in context order, which decides the queue device. */
+	std::string typeNames = "";
+	for (cl_device_id eachDevice : devices)
+	{
+		const DeviceInfo* info = _deviceDatabase.Find(eachDevice);
+		typeNames += typeNames.empty() ? "" : " ";
+		typeNames += info ? DeviceDatabase::GetTypeName(info->type) : "OTHER";
+	}
+	_capture.Set("context-types", typeNames);
+
+	/* Create the context. */
+	_queueDevice = devices[0];
+	TraceSpan contextSpan("clCreateContext");
+	_context.Reset(clCreateContext(0, (cl_uint)devices.size(), devices.data(), NULL, NULL, &result));
+	contextSpan.End();
+
+	if (result != CL_SUCCESS)
+	{
+		stream << "Failed to create context (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	/* Device buffers are carved from 64 MB slabs so batches can reuse them. */
+	result = _deviceArena.Initialize(_context, CL_MEM_READ_WRITE, (size_t)64 * 1024 * 1024);
+
+	if (result != CL_SUCCESS)
+	{
+		stream << "Failed to set up device arena (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	/* Create the command queue. */
+	_commandQueue.Reset(clCreateCommandQueue(_context, _queueDevice, Trace::GetQueueProperties(), &result));
+
+	if (result != CL_SUCCESS)
+	{
+		stream << "Failed to create command queue (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	/* Create an out-of-order queue for the command graph, if the device allows it. */
+	_outOfOrderQueue.Reset(CommandGraph::CreateCommandQueue(_context, _queueDevice, true, &_isOutOfOrder, &result));
+
+	if (result != CL_SUCCESS)
+	{
+		stream << "Failed to create out-of-order command queue (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	/* Create and build the CL program. */
+	const char* kernelAsChar = _kernelString.c_str();
+	_program.Reset(clCreateProgramWithSource(
+		_context, 1,
+		&kernelAsChar, NULL,
+		&result));
+
+	if (result != CL_SUCCESS)
+	{
+		stream << "Failed to create program (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	TraceSpan buildSpan("clBuildProgram");
+	const char* buildOptions = _config.buildOptions.empty() ? NULL : _config.buildOptions.c_str();
+	result = clBuildProgram(_program, 0, NULL, buildOptions, NULL, NULL);
+	buildSpan.End();
+
+	/* Print the error log if there are build errors. */
+	if (result == CL_BUILD_PROGRAM_FAILURE)
+	{
+		stream << "There were build errors: \n";
+
+		/* Determine CL error log size. */
+		size_t errorLogSize;
+		clGetProgramBuildInfo(_program, _queueDevice, CL_PROGRAM_BUILD_LOG, 0, NULL, &errorLogSize);
+
+		/* Get and print the CL error log. */
+		std::vector<char> errorLog(errorLogSize + 1, '\0');
+		clGetProgramBuildInfo(_program, _queueDevice, CL_PROGRAM_BUILD_LOG, errorLogSize, errorLog.data(), NULL);
+		stream << errorLog.data() << "\n\n";
+		return false;
+	}
+	else if (result != CL_SUCCESS)
+	{
+		stream << "Failed to build program (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	/* Create the kernel. */
+	_kernel.Reset(clCreateKernel(_program, _config.kernelName.c_str(), &result));
+
+	if (result != CL_SUCCESS)
+	{
+		stream << "Failed to create kernel " << _config.kernelName << " (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	/* Check the configuration against every device before sizing any buffers. */
+	std::string configError;
+	for (cl_device_id eachDevice : devices)
+	{
+		if (!_config.Validate(eachDevice, _kernel, 2, configError))
+		{
+			stream << "ERROR: " << configError << "\n\n";
+			return false;
+		}
+	}
+
+	_statisticsKernel.Reset(clCreateKernel(_program, "computeColorStatistics", &result));
+
+	if (result != CL_SUCCESS)
+	{
+		stream << "Failed to create statistics kernel (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	_batchedKernel.Reset(clCreateKernel(_program, "scaleBrightnessBatched", &result));
+
+	if (result != CL_SUCCESS)
+	{
+		stream << "Failed to create batched kernel (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	_maxImagesPerLaunch = PixelBatch::GetMaxImagesPerLaunch(_queueDevice);
+	return true;
+}
+
+/**
+	Creates the device buffers, uploads the start pixels and sets the pixel kernel's 
+	arguments, then measures the queue device's bandwidth for the roofline if 
+	--measure-peaks was given.
+*/
+bool PixelRuntime::CreateBuffers()
+{
+	cl_int result = 0;
+	/* Create input and output buffers, padded to whole work-groups. */
+	TraceSpan bufferSpan("Create buffers");
+	_clStartPixels = _deviceArena.Allocate(sizeof(cl_float4) * _config.GetPaddedPixels(), &result);
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to create input buffer (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	_clResultPixels = _deviceArena.Allocate(sizeof(cl_float4) * _config.GetPaddedPixels(), &result);
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to create output buffer (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+	bufferSpan.End();
+
+	/* Write data to the input buffer. */
+	TraceSpan writeSpan("clEnqueueWriteBuffer");
+	TraceCommand writeCommand("Write input");
+	std::chrono::steady_clock::time_point writeStart = std::chrono::steady_clock::now();
+	result = clEnqueueWriteBuffer(
+		_commandQueue, _clStartPixels,
+		CL_TRUE, 0,
+		_bufferSize, _startPixelHostBuffer,
+		0, NULL,
+		writeCommand.GetEvent()
+	);
+	writeSpan.End();
+	_metrics.AddUpload(_bufferSize, GetSecondsSince(writeStart));
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to write to the input buffer (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	/* Set kernel arguments. */
+	result = clSetKernelArg(_kernel, 0, sizeof(cl_mem), &_clStartPixels);
+	result |= clSetKernelArg(_kernel, 1, sizeof(cl_mem), &_clResultPixels);
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to set kernel arguments (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	_metrics.UpdateMemory(_pixelBufferPool, _deviceArena);
+
+	/* Measure the queue device's bandwidth for the roofline, unless it was benchmarked or 
+	the peaks were not asked for. */
+	const DeviceInfo* queueDeviceInfo = _deviceDatabase.Find(_queueDevice);
+
+	if (queueDeviceInfo && (_isMeasuringPeaks || queueDeviceInfo->bandwidthGBs > 0))
+	{
+		TraceSpan rooflineSpan("Measure device bandwidth");
+		_deviceRoofline = Roofline::MeasureDevice(*queueDeviceInfo);
+		std::cout << "Measured " << queueDeviceInfo->name << " copy bandwidth of " << _deviceRoofline.GetPeakGBs() << " GB/s.\n\n";
+	}
+	else if (queueDeviceInfo)
+	{
+		_deviceRoofline = Roofline(queueDeviceInfo->name, 0, queueDeviceInfo->profile.GetPeakGFlops());
+	}
+
+	std::cout << "Finished setting up CL program successfully.\n\n";
+	return true;
+}
+
+/**
+	Runs the pixel kernel --iterations times, reporting each time and the best and mean 
+	of them, then reads back and checks the results. The target name says what the 
+	kernel runs on. The first time, how long after Configure the first frame finished 
+	is reported too.
+*/
+bool PixelRuntime::ExecuteTimed(const std::string& targetName)
+{
+	RecordOperation("timed");
+
+	int bestTime = 0;
+	long long totalTime = 0;
+	for (int iteration = 1; iteration <= _config.iterations; iteration++)
+	{
+		std::cout << "Executing using OpenCL on " << targetName << ". Timer start.\n\n";
+		TraceSpan span("ExecuteTimed");
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (!ExecuteKernel())
+		{
+			return false;
+		}
+		int timeTaken = (int)(GetSecondsSince(start) * 1000);
+		std::cout << "Finished executing using OpenCL on " << targetName << ". Took " << timeTaken << " ms.\n\n";
+
+		if (!_isFirstFrameDone)
+		{
+			std::cout << "First frame done " << (int)(GetSecondsSince(_startTime) * 1000) << " ms after start-up began.\n\n";
+			_isFirstFrameDone = true;
+		}
+
+		bestTime = (iteration == 1) ? timeTaken : std::min(bestTime, timeTaken);
+		totalTime += timeTaken;
+	}
+
+	if (_config.iterations > 1)
+	{
+		std::cout << "Best of " << _config.iterations << " runs took " << bestTime << " ms, mean " << 
+			totalTime / _config.iterations << " ms.\n\n";
+	}
+
+	return CheckKernelResults();
+}
+
+/**
+	Executes the kernel.
+*/
+bool PixelRuntime::ExecuteKernel()
+{
+	cl_int result = 0;
+
+	/* Execute the kernel. */
+	size_t localSize = _config.localSize;
+	size_t globalSize = _config.GetPaddedPixels();
+	TraceSpan enqueueSpan("clEnqueueNDRangeKernel");
+	TraceCommand kernelCommand(_config.kernelName.c_str());
+	std::chrono::steady_clock::time_point kernelStart = std::chrono::steady_clock::now();
+	result = clEnqueueNDRangeKernel(
+		_commandQueue, _kernel,
+		1, NULL,
+		&globalSize, &localSize,
+		0, NULL,
+		kernelCommand.GetEvent()
+	);
+	enqueueSpan.End();
+
+	TraceSpan finishSpan("clFinish");
+	clFinish(_commandQueue);
+	finishSpan.End();
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to execute kernel (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	double kernelSeconds = GetSecondsSince(kernelStart);
+	_metrics.kernelSeconds.RecordSeconds(kernelSeconds);
+	_metrics.AddFrames(1, _config.numPixels, kernelSeconds);
+
+	std::cout << "Finished executing kernel successfully.\n\n";
+	_deviceRoofline.Report(std::cout, HALVE_BYTES_PER_PIXEL * _config.numPixels, HALVE_FLOPS_PER_PIXEL * _config.numPixels, kernelSeconds);
+	return true;
+}
+
+/**
+	Check the results of executing the kernel.
+*/
+bool PixelRuntime::CheckKernelResults()
+{
+	cl_int result = 0;
+
+	if (_resultPixelHostBuffer == nullptr)
+	{
+		std::cout << "Host buffer is null.\n\n";
+		return false;
+	}
+
+	TraceSpan readSpan("clEnqueueReadBuffer");
+	TraceCommand readCommand("Read output");
+	std::chrono::steady_clock::time_point readStart = std::chrono::steady_clock::now();
+	result = clEnqueueReadBuffer(
+		_commandQueue, _clResultPixels,
+		CL_TRUE, 0,
+		_bufferSize, _resultPixelHostBuffer,
+		0, NULL,
+		readCommand.GetEvent()
+	);
+	readSpan.End();
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to read output buffer (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	_metrics.AddDownload(_bufferSize, GetSecondsSince(readStart));
+
+	std::cout << "Finished reading output buffer successfully.\n\n";
+
+	/* Print out a sample from the results. */
+	std::cout << "Sample initial pixel: \n" << 
+		"\tX: " << _startPixels[0].x << "\n"
+		"\tY: " << _startPixels[0].y << "\n"
+		"\tZ: " << _startPixels[0].z << "\n"
+		"\tW: " << _startPixels[0].w << "\n\n";
+	std::cout << "Corresponding result pixel: \n" << 
+		"\tX: " << _resultPixelHostBuffer[0].x << "\n"
+		"\tY: " << _resultPixelHostBuffer[0].y << "\n"
+		"\tZ: " << _resultPixelHostBuffer[0].z << "\n"
+		"\tW: " << _resultPixelHostBuffer[0].w << "\n\n";
+
+	return true;
+}
+
+/**
+	Runs every execution strategy that works on any device in turn, stopping at the 
+	first that fails.
+*/
+bool PixelRuntime::ExecuteStrategies(int argc, char* argv[])
+{
+	return ExecuteStatistics() &&
+		ExecuteBatched() &&
+		ExecuteAsynchronously() &&
+		ExecuteWithCoroutines() &&
+		ExecuteWithGraph() &&
+		ExecuteConcurrently(argc, argv) &&
+		ExecuteWithSvm(argc, argv) &&
+		ExecuteOutOfCore(argc, argv);
+}
+
+/**
+	Computes per-channel statistics of the start pixels in one fused pass, first on the 
+	host and then using OpenCL, and prints both.
+*/
+bool PixelRuntime::ExecuteStatistics()
+{
+	TraceSpan span("ExecuteStatistics");
+	RecordOperation("statistics");
+	const size_t localSize = 64;
+	const size_t numGroups = 256;
+
+	std::cout << "Computing color statistics serially. Timer start.\n\n";
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	PerfRegion perfRegion(_perfCounters, "ColorStatistics::Compute", std::cout);
+	ColorStatistics hostStatistics = ColorStatistics::Compute(_startPixels.data(), _startPixels.size());
+	double seconds = GetSecondsSince(start);
+	std::cout << "Finished computing color statistics serially. Took " << (int)(seconds * 1000) << " ms.\n\n";
+	perfRegion.End();
+	_hostRoofline.Report(std::cout, 
+		STATISTICS_BYTES_PER_PIXEL * _config.numPixels, STATISTICS_FLOPS_PER_PIXEL * _config.numPixels, seconds);
+	PrintStatistics(hostStatistics);
+
+	std::cout << "Computing color statistics using OpenCL. Timer start.\n\n";
+	start = std::chrono::steady_clock::now();
+	ColorStatistics deviceStatistics;
+	cl_int result = ColorStatistics::ComputeOnDevice(
+		_context, _commandQueue, _statisticsKernel,
+		_clStartPixels, (cl_uint)_config.numPixels,
+		localSize, numGroups,
+		deviceStatistics
+	);
+	seconds = GetSecondsSince(start);
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to compute color statistics.\n\n";
+		return false;
+	}
+
+	std::cout << "Finished computing color statistics using OpenCL. Took " << (int)(seconds * 1000) << " ms.\n\n";
+	_deviceRoofline.Report(std::cout, 
+		STATISTICS_BYTES_PER_PIXEL * _config.numPixels, STATISTICS_FLOPS_PER_PIXEL * _config.numPixels, seconds);
+	PrintStatistics(deviceStatistics);
+
+	return true;
+}
+
+/**
+	Splits the start pixels into 64x64 frames and halves all of them with a single 
+	batched launch, then checks the results against the serial run.
+*/
+bool PixelRuntime::ExecuteBatched()
+{
+	TraceSpan span("ExecuteBatched");
+	RecordOperation("batched");
+	const size_t framePixels = 64 * 64;
+	const size_t localSize = 64;
+
+	PixelBatch batch;
+	for (size_t start = 0; start < _startPixels.size(); start += framePixels)
+	{
+		batch.AddImage(&_startPixels[start], std::min(framePixels, _startPixels.size() - start), 0.5f);
+	}
+
+	std::cout << "Executing " << batch.GetImageCount() << " frames in one batch using OpenCL. Timer start.\n\n";
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<cl_float4> batchedPixels;
+	cl_int result = PixelBatch::Execute(
+		_deviceArena, _commandQueue, _batchedKernel,
+		batch,
+		localSize, _maxImagesPerLaunch,
+		batchedPixels
+	);
+	double seconds = GetSecondsSince(start);
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to execute batch.\n\n";
+		return false;
+	}
+
+	std::cout << "Finished executing batch using OpenCL. Took " << (int)(seconds * 1000) << " ms.\n\n";
+	_deviceRoofline.Report(std::cout, 
+		HALVE_BYTES_PER_PIXEL * batchedPixels.size(), HALVE_FLOPS_PER_PIXEL * batchedPixels.size(), seconds);
+	_deviceArena.Print(std::cout);
+	_metrics.AddFrames(batch.GetImageCount(), batchedPixels.size(), seconds);
+	_metrics.UpdateMemory(_pixelBufferPool, _deviceArena);
+
+	/* Check the batch against the serial results. */
+	for (size_t i = 0; i < batchedPixels.size(); i++)
+	{
+		if (batchedPixels[i].x != _resultPixels[i].x || batchedPixels[i].y != _resultPixels[i].y ||
+			batchedPixels[i].z != _resultPixels[i].z || batchedPixels[i].w != _resultPixels[i].w)
+		{
+			std::cout << "Batched result differs from serial result at pixel " << i << ".\n\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+	Halves the pixels in several batches that are submitted without blocking, leaving 
+	the host free while the device works, then collects them all.
+*/
+bool PixelRuntime::ExecuteAsynchronously()
+{
+	TraceSpan span("ExecuteAsynchronously");
+	RecordOperation("asynchronous");
+	const size_t numBatches = 4;
+	const size_t localSize = _config.localSize;
+	size_t batchPixels = (_config.numPixels + numBatches - 1) / numBatches;
+	std::atomic<int> completed(0);
+	AsyncHandle handles[numBatches];
+
+	std::cout << "Submitting " << numBatches << " batches asynchronously using OpenCL. Timer start.\n\n";
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	size_t numSubmitted = 0;
+	for (size_t i = 0; i < numBatches; i++)
+	{
+		size_t firstPixel = i * batchPixels;
+
+		/* Small images can leave the last batches empty. */
+		if (firstPixel >= _config.numPixels)
+		{
+			break;
+		}
+
+		handles[numSubmitted++] = AsyncSubmission::Submit(
+			_commandQueue, _kernel,
+			_clStartPixels, _clResultPixels,
+			_startPixelHostBuffer, _resultPixelHostBuffer,
+			firstPixel, std::min(batchPixels, _config.numPixels - firstPixel), localSize,
+			[&completed](cl_int) { completed++; }
+		);
+	}
+	int submitTime = (int)(GetSecondsSince(start) * 1000);
+	std::cout << "Submitted all batches in " << submitTime << " ms. The host is free until they complete.\n\n";
+
+	cl_int result = AsyncSubmission::WaitAll(handles, numSubmitted);
+	double seconds = GetSecondsSince(start);
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to execute asynchronous batches.\n\n";
+		return false;
+	}
+
+	std::cout << "Finished " << completed << " asynchronous batches using OpenCL. Took " << (int)(seconds * 1000) << " ms.\n\n";
+	_deviceRoofline.Report(std::cout, 
+		HALVE_BYTES_PER_PIXEL * _config.numPixels, HALVE_FLOPS_PER_PIXEL * _config.numPixels, seconds);
+	_metrics.AddFrames(1, _config.numPixels, seconds);
+	_metrics.bytesUploaded.Add(_bufferSize);
+	_metrics.bytesDownloaded.Add(_bufferSize);
+	return true;
+}
+
+/**
+	Halves the pixels in several batches written as coroutines. All of them are resumed 
+	from this thread as their device operations complete.
+*/
+bool PixelRuntime::ExecuteWithCoroutines()
+{
+	TraceSpan span("ExecuteWithCoroutines");
+	RecordOperation("coroutines");
+	const size_t numTasks = 4;
+	size_t taskPixels = (_config.numPixels + numTasks - 1) / numTasks;
+	DeviceScheduler scheduler;
+	AsyncHandle handles[numTasks];
+
+	std::cout << "Executing " << numTasks << " coroutine pipelines using OpenCL. Timer start.\n\n";
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	size_t numSpawned = 0;
+	for (size_t i = 0; i < numTasks; i++)
+	{
+		size_t firstPixel = i * taskPixels;
+
+		/* Small images can leave the last tasks empty. */
+		if (firstPixel >= _config.numPixels)
+		{
+			break;
+		}
+
+		handles[numSpawned++] = scheduler.Spawn(HalveBrightnessTask(scheduler, firstPixel, std::min(taskPixels, _config.numPixels - firstPixel)));
+	}
+	scheduler.Run();
+	cl_int result = AsyncSubmission::WaitAll(handles, numSpawned);
+	double seconds = GetSecondsSince(start);
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to execute coroutine pipelines.\n\n";
+		return false;
+	}
+
+	std::cout << "Finished executing coroutine pipelines using OpenCL. Took " << (int)(seconds * 1000) << " ms.\n\n";
+	_deviceRoofline.Report(std::cout, 
+		HALVE_BYTES_PER_PIXEL * _config.numPixels, HALVE_FLOPS_PER_PIXEL * _config.numPixels, seconds);
+	_metrics.AddFrames(1, _config.numPixels, seconds);
+	_metrics.bytesUploaded.Add(_bufferSize);
+	_metrics.bytesDownloaded.Add(_bufferSize);
+	return true;
+}
+
+/**
+	Halves the pixels as two frames on the out-of-order queue. Wait lists come from each 
+	command's buffer ranges, so uploading the second frame can overlap the first 
+	frame's kernel.
+*/
+bool PixelRuntime::ExecuteWithGraph()
+{
+	TraceSpan span("ExecuteWithGraph");
+	RecordOperation("graph");
+	const size_t numFrames = 2;
+	const size_t localSize = _config.localSize;
+	size_t framePixels = (_config.numPixels + numFrames - 1) / numFrames;
+	CommandGraph graph(_outOfOrderQueue);
+	cl_int result = CL_SUCCESS;
+
+	std::cout << "Executing " << numFrames << " frames on " << (_isOutOfOrder ? "an out-of-order" : "an in-order") << 
+		" queue using OpenCL. Timer start.\n\n";
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < numFrames && result == CL_SUCCESS; i++)
+	{
+		size_t firstPixel = i * framePixels;
+
+		/* Small images can leave the last frames empty. */
+		if (firstPixel >= _config.numPixels)
+		{
+			break;
+		}
+
+		size_t numPixels = std::min(framePixels, _config.numPixels - firstPixel);
+		BufferAccess input = { _clStartPixels, sizeof(cl_float4) * firstPixel, sizeof(cl_float4) * numPixels };
+		BufferAccess output = { _clResultPixels, input.offset, input.size };
+
+		result = graph.AddWrite(_clStartPixels, input.offset, input.size, _startPixelHostBuffer + firstPixel);
+		result |= graph.AddKernel(
+			_kernel, { _clStartPixels, _clResultPixels },
+			{ input }, { output },
+			firstPixel, numPixels, localSize
+		);
+		result |= graph.AddRead(_clResultPixels, output.offset, output.size, _resultPixelHostBuffer + firstPixel);
+	}
+
+	/* Print the derived dependencies before Finish empties the graph. */
+	const std::vector<CommandNode>& nodes = graph.GetNodes();
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		std::cout << "\tCommand " << i << " waits on:";
+		for (size_t eachDependency : nodes[i].dependencies)
+		{
+			std::cout << " " << eachDependency;
+		}
+		std::cout << "\n";
+	}
+	std::cout << "\n";
+
+	cl_int finishResult = graph.Finish();
+	double seconds = GetSecondsSince(start);
+
+	if (result != CL_SUCCESS || finishResult != CL_SUCCESS)
+	{
+		std::cout << "Failed to execute command graph.\n\n";
+		return false;
+	}
+
+	std::cout << "Finished executing command graph using OpenCL. Took " << (int)(seconds * 1000) << " ms.\n\n";
+	_deviceRoofline.Report(std::cout, 
+		HALVE_BYTES_PER_PIXEL * _config.numPixels, HALVE_FLOPS_PER_PIXEL * _config.numPixels, seconds);
+	_metrics.AddFrames(1, _config.numPixels, seconds);
+	_metrics.bytesUploaded.Add(_bufferSize);
+	_metrics.bytesDownloaded.Add(_bufferSize);
+	return true;
+}
+
+/**
+	Halves the pixels in frames submitted from several host threads at once, first from 
+	one thread and then from --submit-threads or PIXELCL_SUBMIT_THREADS (the number of 
+	hardware threads, up to 8, by default). Each submission takes its own queue and 
+	kernel from the submission pool, so the threads never wait on each other's argument 
+	binding. Both runs are checked against the serial results.
+*/
+bool PixelRuntime::ExecuteConcurrently(int argc, char* argv[])
+{
+	const size_t framePixels = 64 * 1024;
+	std::string threads = CommandLine::GetOption(argc, argv, "--submit-threads", "PIXELCL_SUBMIT_THREADS");
+	size_t numThreads = threads.empty() ? 
+		std::min<size_t>(std::max(std::thread::hardware_concurrency(), 2u), 8) : 
+		std::max<size_t>(std::strtoull(threads.c_str(), nullptr, 10), 1);
+	size_t numFrames = (_config.numPixels + framePixels - 1) / framePixels;
+
+	_capture.Set("submit-threads", std::to_string(numThreads));
+
+	TraceSpan span("ExecuteConcurrently");
+	RecordOperation("concurrent");
+
+	/* Each submission needs a slot, so one per thread lets them all run at once. */
+	_submissionPool.Initialize(_context, _queueDevice, _program, _config.kernelName, _config.localSize, numThreads);
+
+	std::vector<cl_float4> resultPixels(_config.numPixels);
+	bool isComparable = IsComparableWithSerial();
+	double singleSeconds = 0;
+	for (size_t eachThreadCount : { (size_t)1, numThreads })
+	{
+		std::cout << "Submitting " << numFrames << " frames from " << eachThreadCount << 
+			(eachThreadCount == 1 ? " thread" : " threads") << " using OpenCL. Timer start.\n\n";
+
+		cl_int result = CL_SUCCESS;
+		double seconds = ProcessConcurrently(eachThreadCount, framePixels, resultPixels, &result);
+
+		if (result != CL_SUCCESS)
+		{
+			std::cout << "Failed to submit frames concurrently (" << ClError::GetName(result) << ").\n\n";
+			return false;
+		}
+
+		std::cout << "Finished submitting from " << eachThreadCount << (eachThreadCount == 1 ? " thread" : " threads") << 
+			". Took " << (int)(seconds * 1000) << " ms (" << (seconds > 0 ? numFrames / seconds : 0) << " frames/s";
+		if (eachThreadCount == 1)
+		{
+			singleSeconds = seconds;
+		}
+		else if (seconds > 0)
+		{
+			std::cout << ", " << singleSeconds / seconds << "x one thread";
+		}
+		std::cout << ", " << _submissionPool.GetSlotCount() << " queues).\n\n";
+
+		_deviceRoofline.Report(std::cout, 
+			HALVE_BYTES_PER_PIXEL * _config.numPixels, HALVE_FLOPS_PER_PIXEL * _config.numPixels, seconds);
+		_metrics.AddFrames(numFrames, _config.numPixels, seconds);
+		_metrics.bytesUploaded.Add(_bufferSize);
+		_metrics.bytesDownloaded.Add(_bufferSize);
+
+		/* Check the frames against the serial results. */
+		for (size_t i = 0; isComparable && i < resultPixels.size(); i++)
+		{
+			if (resultPixels[i].x != _resultPixels[i].x || resultPixels[i].y != _resultPixels[i].y ||
+				resultPixels[i].z != _resultPixels[i].z || resultPixels[i].w != _resultPixels[i].w)
+			{
+				std::cout << "Concurrent result differs from serial result at pixel " << i << ".\n\n";
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+	Halves the pixels through shared virtual memory, in the most capable mode the queue 
+	device reports, so no buffer is uploaded or read back. Devices without SVM, runs 
+	with --no-svm or PIXELCL_NO_SVM, and SVM runs that fail use the device buffers 
+	instead. The results are checked against the serial run either way.
+*/
+bool PixelRuntime::ExecuteWithSvm(int argc, char* argv[])
+{
+	bool isDisabled = CommandLine::HasFlag(argc, argv, "--no-svm", "PIXELCL_NO_SVM");
+	SvmMode mode = isDisabled ? SVM_NONE : SharedVirtualMemory::GetMode(_queueDevice);
+	std::vector<cl_float4> resultPixels(_config.numPixels);
+	cl_int result = CL_INVALID_OPERATION;
+
+	_capture.Set("no-svm", isDisabled ? "1" : "0");
+
+	TraceSpan span("ExecuteWithSvm");
+	RecordOperation("svm");
+
+	if (mode != SVM_NONE)
+	{
+		/* An instance of its own, so the buffer path's arguments are left alone. */
+		ClKernel svmKernel(clCreateKernel(_program, _config.kernelName.c_str(), &result));
+
+		std::cout << "Executing using OpenCL with " << SharedVirtualMemory::GetModeName(mode) << 
+			" shared virtual memory. Timer start.\n\n";
+		double seconds = 0;
+
+		if (result == CL_SUCCESS)
+		{
+			result = SharedVirtualMemory::Execute(
+				_context, _commandQueue, svmKernel, mode,
+				_startPixelHostBuffer, resultPixels.data(), _config.numPixels, _config.localSize,
+				&seconds
+			);
+		}
+
+		if (result == CL_SUCCESS)
+		{
+			std::cout << "Finished executing with shared virtual memory. Took " << (int)(seconds * 1000) << " ms" << 
+				(mode == SVM_FINE_GRAIN_SYSTEM ? "" : ", including copying the pixels in and the results out") << ".\n\n";
+			_deviceRoofline.Report(std::cout, 
+				HALVE_BYTES_PER_PIXEL * _config.numPixels, HALVE_FLOPS_PER_PIXEL * _config.numPixels, seconds);
+			_metrics.AddFrames(1, _config.numPixels, seconds);
+		}
+		else
+		{
+			std::cout << "Shared virtual memory failed (" << ClError::GetName(result) << "). Using device buffers instead.\n\n";
+		}
+	}
+	else
+	{
+		std::cout << (isDisabled ? "Shared virtual memory is turned off" : "The device has no shared virtual memory") << 
+			". Using device buffers instead.\n\n";
+	}
+
+	/* Fall back to uploading, halving and reading back through the device buffers. */
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Executing using OpenCL with device buffers. Timer start.\n\n";
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		result = clEnqueueWriteBuffer(_commandQueue, _clStartPixels, CL_TRUE, 0, _bufferSize, _startPixelHostBuffer, 0, NULL, NULL);
+
+		if (result != CL_SUCCESS || !ExecuteKernel())
+		{
+			std::cout << "Failed to execute with device buffers.\n\n";
+			return false;
+		}
+
+		result = clEnqueueReadBuffer(_commandQueue, _clResultPixels, CL_TRUE, 0, _bufferSize, resultPixels.data(), 0, NULL, NULL);
+
+		if (result != CL_SUCCESS)
+		{
+			std::cout << "Failed to read output buffer (" << ClError::GetName(result) << ").\n\n";
+			return false;
+		}
+
+		double seconds = GetSecondsSince(start);
+		std::cout << "Finished executing with device buffers. Took " << (int)(seconds * 1000) << " ms.\n\n";
+		_metrics.bytesUploaded.Add(_bufferSize);
+		_metrics.bytesDownloaded.Add(_bufferSize);
+	}
+
+	/* Check the results against the serial run. */
+	bool isComparable = IsComparableWithSerial();
+	for (size_t i = 0; isComparable && i < resultPixels.size(); i++)
+	{
+		if (resultPixels[i].x != _resultPixels[i].x || resultPixels[i].y != _resultPixels[i].y ||
+			resultPixels[i].z != _resultPixels[i].z || resultPixels[i].w != _resultPixels[i].w)
+		{
+			std::cout << "Shared virtual memory result differs from serial result at pixel " << i << ".\n\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+	Streams a pixel file through the configured pixel kernel when --input or PIXELCL_INPUT 
+	is given, writing the results to --output (the input path plus ".out" by default). 
+	--generate=N first fills the input file with N random pixels from the run's seed, 
+	and --window sets the window size in pixels. Both accept k, M and G suffixes. Memory use stays the same however big 
+	the file is.
+*/
+bool PixelRuntime::ExecuteOutOfCore(int argc, char* argv[])
+{
+	const size_t localSize = _config.localSize;
+	std::string inputPath = CommandLine::GetOption(argc, argv, "--input", "PIXELCL_INPUT");
+
+	if (inputPath.empty())
+	{
+		return true;
+	}
+
+	std::string outputPath = CommandLine::GetOption(argc, argv, "--output", "PIXELCL_OUTPUT");
+
+	if (outputPath.empty())
+	{
+		outputPath = inputPath + ".out";
+	}
+	else if (PixelStream::IsSameFile(inputPath, outputPath))
+	{
+		std::cout << "ERROR: --output must not be the --input file, which it would overwrite before it is read.\n\n";
+		return false;
+	}
+
+	std::string generate = CommandLine::GetOption(argc, argv, "--generate", "PIXELCL_GENERATE");
+	std::string window = CommandLine::GetOption(argc, argv, "--window", "PIXELCL_WINDOW");
+	unsigned long long numPixels = 0;
+	unsigned long long requestedWindowPixels = 0;
+
+	if (!generate.empty() && !RunConfig::ParseCount(generate, numPixels))
+	{
+		std::cout << "ERROR: --generate must be a pixel count such as 16M, not \"" << generate << "\".\n\n";
+		return false;
+	}
+
+	if (!window.empty() && !RunConfig::ParseCount(window, requestedWindowPixels))
+	{
+		std::cout << "ERROR: --window must be a pixel count such as 1M, not \"" << window << "\".\n\n";
+		return false;
+	}
+
+	if (!generate.empty())
+	{
+		std::cout << "Writing " << numPixels << " random pixels to " << inputPath << "...\n\n";
+
+		if (!PixelStream::GenerateFile(inputPath, numPixels, _config.seed))
+		{
+			std::cout << "Failed to write " << inputPath << ".\n\n";
+			return false;
+		}
+	}
+
+	size_t windowPixels = PixelStream::GetWindowPixels(_queueDevice, (size_t)requestedWindowPixels, localSize);
+
+	_capture.Set("input", inputPath);
+	_capture.Set("output", outputPath);
+	_capture.Set("generate", generate);
+	_capture.Set("window", window);
+
+	TraceSpan span("ExecuteOutOfCore");
+	RecordOperation("out-of-core");
+	std::cout << "Streaming " << inputPath << " to " << outputPath << " in windows of " << windowPixels << " pixels.\n\n";
+	StreamStatistics statistics;
+
+	/* An instance of its own, so the stream's window buffers do not replace _kernel's arguments. */
+	cl_int result = CL_SUCCESS;
+	ClKernel streamKernel(clCreateKernel(_program, _config.kernelName.c_str(), &result));
+
+	if (result == CL_SUCCESS)
+	{
+		result = PixelStream::Process(
+			_deviceArena, _pixelBufferPool,
+			_commandQueue, streamKernel,
+			inputPath, outputPath,
+			windowPixels, localSize,
+			statistics
+		);
+	}
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to stream " << inputPath << " (" << ClError::GetName(result) << ").\n\n";
+		return false;
+	}
+
+	double megabytes = statistics.pixels * sizeof(cl_float4) / (1024.0 * 1024.0);
+	std::cout << "Finished streaming " << statistics.pixels << " pixels in " << statistics.windows << " windows. Took " << 
+		(int)(statistics.seconds * 1000) << " ms (" << (statistics.seconds > 0 ? megabytes / statistics.seconds : 0) << " MB/s).\n\n";
+
+	_deviceRoofline.Report(std::cout, 
+		HALVE_BYTES_PER_PIXEL * statistics.pixels, HALVE_FLOPS_PER_PIXEL * statistics.pixels, statistics.seconds);
+
+	_metrics.AddFrames(statistics.windows, statistics.pixels, statistics.seconds);
+	_metrics.bytesUploaded.Add(statistics.pixels * sizeof(cl_float4));
+	_metrics.bytesDownloaded.Add(statistics.pixels * sizeof(cl_float4));
+	_metrics.UpdateMemory(_pixelBufferPool, _deviceArena);
+
+	return true;
+}
+
+/**
+	Halves the pixels with a CPU device split into affinity domains, when --fission=numa 
+	or --fission=l3 (or PIXELCL_FISSION) is given. Each domain has its own queue. With 
+	NUMA domains, each range of host memory is first touched from its own node.
+*/
+bool PixelRuntime::ExecuteWithFission(int argc, char* argv[], cl_device_id device)
+{
+	const size_t localSize = _config.localSize;
+	std::string domainName = CommandLine::GetOption(argc, argv, "--fission", "PIXELCL_FISSION");
+	cl_device_affinity_domain affinityDomain = DeviceFission::ParseAffinityDomain(domainName);
+
+	if (affinityDomain == 0)
+	{
+		return true;
+	}
+
+	_capture.Set("fission", domainName);
+
+	TraceSpan span("ExecuteWithFission");
+	RecordOperation("fission");
+	DeviceFission fission;
+	cl_int result = fission.Partition(device, affinityDomain);
+
+	if (result == CL_SUCCESS)
+	{
+		result = fission.Build(_kernelString, _config.kernelName.c_str());
+	}
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to set up device fission.\n\n";
+		return false;
+	}
+
+	fission.AssignRanges(_config.numPixels);
+
+	if (fission.IsPartitioned())
+	{
+		std::cout << "Split CPU into " << fission.GetDomains().size() << " " << domainName << " domains.\n\n";
+	}
+	else
+	{
+		std::cout << "CPU cannot be split by " << domainName << " domain. Using the whole CPU.\n\n";
+	}
+
+	/* Take aligned buffers from the pool for CL_MEM_USE_HOST_PTR, then let each domain
+	touch its own range first. */
+	cl_float4* startPixels = _pixelBufferPool.Acquire(_config.numPixels);
+	cl_float4* resultPixels = _pixelBufferPool.Acquire(_config.numPixels);
+
+	if (!startPixels || !resultPixels)
+	{
+		std::cout << "Failed to allocate host buffers for CPU affinity domains.\n\n";
+		_pixelBufferPool.Release(startPixels);
+		_pixelBufferPool.Release(resultPixels);
+		return false;
+	}
+
+	fission.FirstTouch([&](const FissionDomain& domain)
+	{
+		std::copy(
+			_startPixels.begin() + domain.firstPixel,
+			_startPixels.begin() + domain.firstPixel + domain.numPixels,
+			startPixels + domain.firstPixel);
+		std::fill(
+			resultPixels + domain.firstPixel,
+			resultPixels + domain.firstPixel + domain.numPixels,
+			cl_float4());
+	});
+
+	std::cout << "Executing using OpenCL on CPU affinity domains. Timer start.\n\n";
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	result = fission.Execute(startPixels, resultPixels, _config.numPixels, localSize);
+	double seconds = GetSecondsSince(start);
+	bool matches = (result == CL_SUCCESS);
+
+	if (result != CL_SUCCESS)
+	{
+		std::cout << "Failed to execute on CPU affinity domains.\n\n";
+	}
+	else
+	{
+		std::cout << "Finished executing using OpenCL on CPU affinity domains. Took " << (int)(seconds * 1000) << " ms.\n\n";
+		_deviceRoofline.Report(std::cout, 
+			HALVE_BYTES_PER_PIXEL * _config.numPixels, HALVE_FLOPS_PER_PIXEL * _config.numPixels, seconds);
+		_metrics.AddFrames(1, _config.numPixels, seconds);
+	}
+
+	/* Check the results against the serial run. */
+	bool isComparable = IsComparableWithSerial();
+	for (size_t i = 0; isComparable && matches && i < _config.numPixels; i++)
+	{
+		if (resultPixels[i].x != _resultPixels[i].x || resultPixels[i].y != _resultPixels[i].y ||
+			resultPixels[i].z != _resultPixels[i].z || resultPixels[i].w != _resultPixels[i].w)
+		{
+			std::cout << "Affinity domain result differs from serial result at pixel " << i << ".\n\n";
+			matches = false;
+		}
+	}
+
+	/* Hand the buffers back so the next batch can reuse them. */
+	_pixelBufferPool.Release(startPixels);
+	_pixelBufferPool.Release(resultPixels);
+	return matches;
+}
+
+/**
+	Runs the workload recorded in the file loaded with --replay: generates the same 
+	pixels while devices of the recorded types are set up, then runs the recorded 
+	operations in order. The serial results are always worked out, since the other 
+	operations are checked against them. Any recorded setting given again on the command line or in the environment 
+	is used instead, so --device, --device-types and --context-types move the workload 
+	to another device.
+*/
+bool PixelRuntime::Replay(int argc, char* argv[])
+{
+	std::vector<std::string> operations = 
+		WorkloadCapture::SplitList(CommandLine::GetOption(argc, argv, "--operations", "PIXELCL_OPERATIONS"));
+	std::vector<cl_device_type> deviceTypes = 
+		ParseTypes(CommandLine::GetOption(argc, argv, "--device-types", "PIXELCL_DEVICE_TYPES"));
+	std::vector<cl_device_type> contextTypes = 
+		ParseTypes(CommandLine::GetOption(argc, argv, "--context-types", "PIXELCL_CONTEXT_TYPES"));
+
+	if (operations.empty())
+	{
+		std::cout << "ERROR: The workload has no operations to replay.\n\n";
+		return false;
+	}
+
+	/* Set up the devices while the pixels are generated, unless only the host ran. */
+	bool usesDevices = std::any_of(operations.begin(), operations.end(), [](const std::string& eachOperation) 
+	{
+		return eachOperation != "serial";
+	});
+
+	if (usesDevices)
+	{
+		if (deviceTypes.empty() || contextTypes.empty())
+		{
+			std::cout << "ERROR: The workload does not say which devices it ran on.\n\n";
+			return false;
+		}
+
+		/* The recorded device was picked for the recorded types, so device types given 
+		again replace it unless a device is given again too. */
+		if (CommandLine::IsGiven(argc, argv, "--device-types", "PIXELCL_DEVICE_TYPES") && 
+			!CommandLine::IsGiven(argc, argv, "--device", "PIXELCL_DEVICE"))
+		{
+			_config.device = "";
+		}
+
+		StartSetUp(argc, argv, deviceTypes, contextTypes);
+	}
+
+	if (!GeneratePixels(argc, argv))
+	{
+		return false;
+	}
+
+	/* The device operations check their results against the serial run's, so work them 
+	out even when the serial run is not replayed. */
+	if (std::find(operations.begin(), operations.end(), "serial") == operations.end())
+	{
+		_resultPixels.resize(_startPixels.size());
+		Pixel::HalveBrightness(_startPixels.data(), _resultPixels.data(), _startPixels.size());
+	}
+
+	/* Name the target the way the parts do, such as "CPU and GPU". */
+	std::string targetName = "";
+	for (cl_device_type eachType : contextTypes)
+	{
+		targetName += (targetName.empty() ? "" : " and ") + DeviceDatabase::GetTypeName(eachType);
+	}
+
+	bool isSetUp = false;
+	for (const std::string& eachOperation : operations)
+	{
+		std::cout << "Replaying " << eachOperation << ".\n\n";
+
+		/* Only the serial run happens before the devices are set up. */
+		if (eachOperation == "serial")
+		{
+			ExecuteSerially();
+			continue;
+		}
+
+		if (!isSetUp)
+		{
+			if (!FinishSetUp())
+			{
+				return false;
+			}
+			isSetUp = true;
+		}
+
+		bool succeeded = false;
+		if (eachOperation == "timed")
+		{
+			succeeded = ExecuteTimed(targetName);
+		}
+		else if (eachOperation == "statistics")
+		{
+			succeeded = ExecuteStatistics();
+		}
+		else if (eachOperation == "batched")
+		{
+			succeeded = ExecuteBatched();
+		}
+		else if (eachOperation == "asynchronous")
+		{
+			succeeded = ExecuteAsynchronously();
+		}
+		else if (eachOperation == "coroutines")
+		{
+			succeeded = ExecuteWithCoroutines();
+		}
+		else if (eachOperation == "graph")
+		{
+			succeeded = ExecuteWithGraph();
+		}
+		else if (eachOperation == "concurrent")
+		{
+			succeeded = ExecuteConcurrently(argc, argv);
+		}
+		else if (eachOperation == "svm")
+		{
+			succeeded = ExecuteWithSvm(argc, argv);
+		}
+		else if (eachOperation == "out-of-core")
+		{
+			succeeded = ExecuteOutOfCore(argc, argv);
+		}
+		else if (eachOperation == "fission" && GetDevice(CL_DEVICE_TYPE_CPU))
+		{
+			succeeded = ExecuteWithFission(argc, argv, GetDevice(CL_DEVICE_TYPE_CPU));
+		}
+		else
+		{
+			std::cout << "ERROR: Cannot replay operation \"" << eachOperation << "\" on the selected devices.\n\n";
+		}
+
+		if (!succeeded)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+	Waits for any set-up still running, writes the trace, if one is being recorded, and 
+	cleans up OpenCL memory objects. Safe to call more than once.
+*/
+void PixelRuntime::CleanUpCl()
+{
+	/* A set-up still running on its thread may be creating objects released below. */
+	if (_setUpThread.joinable())
+	{
+		_setUpThread.join();
+	}
+
+	/* Write the trace while its commands' queues still exist. */
+	if (!_tracePath.empty())
+	{
+		if (Trace::Stop())
+		{
+			std::cout << "Wrote trace to " << _tracePath << ".\n\n";
+		}
+		else
+		{
+			std::cout << "Failed to write trace to " << _tracePath << ".\n\n";
+		}
+		_tracePath = "";
+	}
+
+	/* Stop exporting metrics, dumping them one last time. */
+	_metrics.UpdateMemory(_pixelBufferPool, _deviceArena);
+	_metricsExporter.Stop();
+
+	/* Free OpenCL memory objects. */
+	_deviceArena.Free(_clStartPixels);
+	_deviceArena.Free(_clResultPixels);
+	_deviceArena.Release();
+	_clStartPixels = nullptr;
+	_clResultPixels = nullptr;
+	_submissionPool.Release();
+	_batchedKernel.Reset();
+	_statisticsKernel.Reset();
+	_kernel.Reset();
+	_program.Reset();
+	_outOfOrderQueue.Reset();
+	_commandQueue.Reset();
+	_context.Reset();
+
+	/* Return host buffers to the pool. */
+	_pixelBufferPool.Release(_startPixelHostBuffer);
+	_pixelBufferPool.Release(_resultPixelHostBuffer);
+	_startPixelHostBuffer = nullptr;
+	_resultPixelHostBuffer = nullptr;
+	_pixelBufferPool.Trim();
+}
+
+/**
+	Returns the settings for this run.
+*/
+const RunConfig& PixelRuntime::GetConfig() const
+{
+	return _config;
+}
+
+/**
+	Starts exporting metrics if --metrics-port or --metrics-file (or PIXELCL_METRICS_PORT 
+	or PIXELCL_METRICS_FILE) is given. The port serves them over HTTP on 127.0.0.1, and 
+	the file is rewritten every --metrics-interval seconds, 10 by default.
+*/
+bool PixelRuntime::StartMetrics(int argc, char* argv[])
+{
+	std::string port = CommandLine::GetOption(argc, argv, "--metrics-port", "PIXELCL_METRICS_PORT");
+	std::string dumpPath = CommandLine::GetOption(argc, argv, "--metrics-file", "PIXELCL_METRICS_FILE");
+	std::string interval = CommandLine::GetOption(argc, argv, "--metrics-interval", "PIXELCL_METRICS_INTERVAL");
+
+	if (port.empty() && dumpPath.empty())
+	{
+		return true;
+	}
+
+	int portNumber = std::atoi(port.c_str());
+	int dumpSeconds = interval.empty() ? 10 : std::atoi(interval.c_str());
+
+	if (!_metricsExporter.Start(portNumber, dumpPath, dumpSeconds))
+	{
+		std::cout << "ERROR: Could not serve metrics on port " << port << ".\n\n";
+		return false;
+	}
+
+	if (portNumber != 0)
+	{
+		std::cout << "Serving metrics at http://127.0.0.1:" << portNumber << "/metrics\n";
+	}
+	if (!dumpPath.empty())
+	{
+		std::cout << "Writing metrics to " << dumpPath << " every " << dumpSeconds << " s\n";
+	}
+	std::cout << "\n";
+
+	return true;
+}
+
+/**
+	Reads in the contents of the kernel file. Without a --kernel-file, Kernel.cl is 
+	looked for in the working directory and then in the library's source directory, so 
+	that the parts also run from their project directories. Errors go to the given 
+	stream.
+*/
+bool PixelRuntime::ReadKernelFile(std::ostream& stream)
+{
+	std::vector<std::string> kernelFilePaths;
+
+	if (!_kernelFilePath.empty())
+	{
+		kernelFilePaths.push_back(_kernelFilePath);
+	}
+	else
+	{
+		kernelFilePaths.push_back("Kernel.cl");
+		kernelFilePaths.push_back("../PixelCL/Kernel.cl");
+	}
+
+	std::ifstream fileStream;
+	for (const std::string& eachPath : kernelFilePaths)
+	{
+		fileStream.open(eachPath);
+
+		if (fileStream)
+		{
+			break;
+		}
+		fileStream.clear();
+	}
+
+	if(!fileStream.is_open())
+	{
+		stream << "Failed to open kernel file.\n\n";
+		return false;
+	}
+
+	/* Get each line, keeping the line breaks so that line comments end where they should. */
+	_kernelString = "";
+	std::string eachLine;
+	while (std::getline(fileStream, eachLine))
+	{
+		_kernelString += eachLine + "\n";
+	}
+	fileStream.close();
+
+	/* Check that the file was not empty. */
+	if (_kernelString.length() < 1)
+	{
+		stream << "Kernel file is empty.\n\n";
+		return false;
+	}
+
+	return true;
+}
+
+/**
+	Halves the start pixels into resultPixels from numThreads threads, each taking the 
+	next frame of framePixels until none are left, and returns the wall-clock seconds 
+	it took. The first error any thread hits is returned in result.
+*/
+double PixelRuntime::ProcessConcurrently(size_t numThreads, size_t framePixels, std::vector<cl_float4>& resultPixels, cl_int* result)
+{
+	std::atomic<size_t> nextFrame(0);
+	std::atomic<cl_int> firstError(CL_SUCCESS);
+	std::vector<std::thread> threads;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < numThreads; i++)
+	{
+		threads.push_back(std::thread([&]()
+		{
+			TraceSpan threadSpan("Submit frames");
+
+			for (size_t frame = nextFrame++; frame * framePixels < _config.numPixels; frame = nextFrame++)
+			{
+				size_t firstPixel = frame * framePixels;
+				size_t numPixels = std::min(framePixels, _config.numPixels - firstPixel);
+				cl_int frameResult = _submissionPool.Process(_startPixelHostBuffer + firstPixel, resultPixels.data() + firstPixel, numPixels);
+
+				if (frameResult != CL_SUCCESS)
+				{
+					cl_int expected = CL_SUCCESS;
+					firstError.compare_exchange_strong(expected, frameResult);
+					return;
+				}
+			}
+		}));
+	}
+
+	for (std::thread& eachThread : threads)
+	{
+		eachThread.join();
+	}
+
+	*result = firstError;
+	return GetSecondsSince(start);
+}
+
+/**
+	Selects devices of the given types, then builds the program for the selected 
+	devices of contextTypes, writing to the given stream.
+*/
+bool PixelRuntime::RunSetUp(
+	int argc, char* argv[], 
+	const std::vector<cl_device_type>& types, 
+	const std::vector<cl_device_type>& contextTypes, 
+	std::ostream& stream)
+{
+	if (!SelectDevices(argc, argv, types, stream))
+	{
+		return false;
+	}
+
+	std::vector<cl_device_id> devices;
+	for (cl_device_type eachType : contextTypes)
+	{
+		cl_device_id device = GetDevice(eachType);
+
+		if (!device)
+		{
+			stream << "ERROR: No " << DeviceDatabase::GetTypeName(eachType) << " was selected for the context.\n\n";
+			return false;
+		}
+		devices.push_back(device);
+	}
+
+	return BuildProgram(devices, stream);
+}
+
+/**
+	Records that an operation is about to run, if a workload is being recorded. It is 
+	recorded before it runs, so a run that crashes leaves the operation that crashed it 
+	in the workload.
+*/
+void PixelRuntime::RecordOperation(const std::string& name)
+{
+	if (!_capture.AddOperation(name))
+	{
+		std::cout << "Failed to write workload to " << _capture.GetPath() << ".\n\n";
+	}
+}
+
+/**
+	Returns whether the configured pixel kernel's results can be checked against the 
+	serial run, which only halves. Says so when they cannot.
+*/
+bool PixelRuntime::IsComparableWithSerial()
+{
+	if (_config.kernelName == SERIAL_KERNEL_NAME)
+	{
+		return true;
+	}
+
+	std::cout << "Not checking " << _config.kernelName << " against the serial run, which uses " << SERIAL_KERNEL_NAME << ".\n\n";
+	return false;
+}
+
+/**
+	Uploads, halves and reads back one range of pixels, awaiting each step in turn.
+*/
+DeviceTask PixelRuntime::HalveBrightnessTask(DeviceScheduler& scheduler, size_t firstPixel, size_t numPixels)
+{
+	const size_t localSize = _config.localSize;
+	size_t offset = sizeof(cl_float4) * firstPixel;
+	size_t size = sizeof(cl_float4) * numPixels;
+
+	cl_int result = co_await scheduler.Write(_commandQueue, _clStartPixels, offset, size, _startPixelHostBuffer + firstPixel);
+	if (result != CL_SUCCESS)
+	{
+		co_return result;
+	}
+
+	result = co_await scheduler.Kernel(_commandQueue, _kernel, firstPixel, numPixels, localSize);
+	if (result != CL_SUCCESS)
+	{
+		co_return result;
+	}
+
+	co_return co_await scheduler.Read(_commandQueue, _clResultPixels, offset, size, _resultPixelHostBuffer + firstPixel);
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Returns the wall-clock seconds since the given time.
+*/
+double PixelRuntime::GetSecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+	Returns the device types named in a recorded list, such as "GPU CPU". Names that are 
+	not device types are skipped.
+*/
+std::vector<cl_device_type> PixelRuntime::ParseTypes(const std::string& list)
+{
+	std::vector<cl_device_type> types;
+
+	for (const std::string& eachName : WorkloadCapture::SplitList(list))
+	{
+		cl_device_type type = DeviceDatabase::ParseType(eachName);
+
+		if (type != 0)
+		{
+			types.push_back(type);
+		}
+	}
+
+	return types;
+}
+
+/**
+	Prints the per-channel statistics of a collection of pixels.
+*/
+void PixelRuntime::PrintStatistics(const ColorStatistics& statistics)
+{
+	cl_float4 min = statistics.GetMin();
+	cl_float4 max = statistics.GetMax();
+	cl_float4 mean = statistics.GetMean();
+	cl_float4 variance = statistics.GetVariance();
+
+	std::cout << "Color statistics over " << statistics.count << " pixels: \n" << 
+		"\tMin:      " << min.x << ", " << min.y << ", " << min.z << ", " << min.w << "\n"
+		"\tMax:      " << max.x << ", " << max.y << ", " << max.z << ", " << max.w << "\n"
+		"\tMean:     " << mean.x << ", " << mean.y << ", " << mean.z << ", " << mean.w << "\n"
+		"\tVariance: " << variance.x << ", " << variance.y << ", " << variance.z << ", " << variance.w << "\n\n";
+}
@@ -0,0 +1,180 @@
+/*===================================================================================*//**
+	PixelRuntime
+	
+	Device discovery, context, program and buffer management, execution and timing 
+	shared by the OpenCL parts.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see PixelRuntime
+	@see PixelRuntime.cpp
+	
+*//*====================================================================================*/
+
+#ifndef PIXEL_RUNTIME_H
+#define PIXEL_RUNTIME_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <chrono>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <CL/cl.h>
+#include "ClHandle.h"
+#include "ColorStatistics.h"
+#include "DeviceArena.h"
+#include "DeviceCoroutines.h"
+#include "DeviceDatabase.h"
+#include "MetricsExporter.h"
+#include "NumaAllocator.h"
+#include "PerfCounters.h"
+#include "PixelBufferPool.h"
+#include "PixelMetrics.h"
+#include "Roofline.h"
+#include "RunConfig.h"
+#include "SubmissionPool.h"
+#include "WorkloadCapture.h"
+
+/*========================================================================================
+	PixelRuntime
+========================================================================================*/
+/**
+	Everything a part needs to run the pixel kernels: the run settings, the host pixels 
+	and their serial results, the selected devices, and one context, program and pair 
+	of device buffers shared by every execution strategy.
+	
+	A part configures the runtime, selects the device types it runs on, sets up CL on 
+	those devices and then runs the strategies. Each strategy checks or reports its own 
+	results and prints how long it took, so new strategies are added here once and 
+	timed the same way on every part. StartSetUp and FinishSetUp select the devices and 
+	build the program on a background thread while the pixels are generated.
+	
+	The OpenCL objects are held in ClHandles, so whatever setup step fails, everything 
+	created before it is released when the runtime is destroyed.
+	
+	With --capture, the settings, devices and strategies of a run are recorded to a 
+	workload file, and Replay runs a recorded workload again in the same order.
+	
+	@see PixelRuntime.cpp
+*/
+class PixelRuntime
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		RunConfig _config;
+		std::vector<cl_float4> _startPixels;
+		std::vector<cl_float4> _resultPixels;
+		cl_float4* _startPixelHostBuffer;
+		cl_float4* _resultPixelHostBuffer;
+		NumaPolicy _numaPolicy;
+		PixelBufferPool _pixelBufferPool;
+
+		DeviceDatabase _deviceDatabase;
+		DeviceArena _deviceArena;
+		PixelMetrics _metrics;
+		MetricsExporter _metricsExporter;
+		Roofline _hostRoofline;
+		Roofline _deviceRoofline;
+		bool _isMeasuringPeaks;
+		PerfCounters _perfCounters;
+		WorkloadCapture _capture;
+
+		std::thread _setUpThread;
+		std::ostringstream _setUpLog;
+		bool _isSetUp;
+		double _setUpSeconds;
+		std::chrono::steady_clock::time_point _startTime;
+		bool _isFirstFrameDone;
+
+		std::vector<cl_device_type> _deviceTypes;
+		std::vector<cl_device_id> _devices;
+		cl_device_id _queueDevice;
+
+		ClContext _context;
+		ClCommandQueue _commandQueue;
+		ClCommandQueue _outOfOrderQueue;
+		bool _isOutOfOrder;
+		std::string _kernelFilePath;
+		std::string _tracePath;
+		std::string _kernelString;
+		ClProgram _program;
+		ClKernel _kernel;
+		ClKernel _statisticsKernel;
+		ClKernel _batchedKernel;
+		SubmissionPool _submissionPool;
+		size_t _maxImagesPerLaunch;
+		size_t _bufferSize;
+		cl_mem _clStartPixels;
+		cl_mem _clResultPixels;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		PixelRuntime();
+		~PixelRuntime();
+		PixelRuntime(const PixelRuntime&) = delete;
+		PixelRuntime& operator=(const PixelRuntime&) = delete;
+
+		bool Configure(int argc, char* argv[]);
+		bool GeneratePixels(int argc, char* argv[]);
+		void ExecuteSerially();
+		bool SelectDevices(int argc, char* argv[], const std::vector<cl_device_type>& types);
+		cl_device_id GetDevice(cl_device_type type) const;
+		void StartSetUp(
+			int argc, char* argv[], 
+			const std::vector<cl_device_type>& types, 
+			const std::vector<cl_device_type>& contextTypes);
+		bool FinishSetUp();
+		bool SetUpCL(const std::vector<cl_device_id>& devices);
+		bool ExecuteTimed(const std::string& targetName);
+		bool ExecuteKernel();
+		bool CheckKernelResults();
+		bool ExecuteStrategies(int argc, char* argv[]);
+		bool ExecuteStatistics();
+		bool ExecuteBatched();
+		bool ExecuteAsynchronously();
+		bool ExecuteWithCoroutines();
+		bool ExecuteWithGraph();
+		bool ExecuteConcurrently(int argc, char* argv[]);
+		bool ExecuteWithSvm(int argc, char* argv[]);
+		bool ExecuteOutOfCore(int argc, char* argv[]);
+		bool ExecuteWithFission(int argc, char* argv[], cl_device_id device);
+		bool Replay(int argc, char* argv[]);
+		void CleanUpCl();
+		const RunConfig& GetConfig() const;
+
+    private:
+		bool SelectDevices(int argc, char* argv[], const std::vector<cl_device_type>& types, std::ostream& stream);
+		bool BuildProgram(const std::vector<cl_device_id>& devices, std::ostream& stream);
+		bool CreateBuffers();
+		double ProcessConcurrently(size_t numThreads, size_t framePixels, std::vector<cl_float4>& resultPixels, cl_int* result);
+		bool RunSetUp(
+			int argc, char* argv[], 
+			const std::vector<cl_device_type>& types, 
+			const std::vector<cl_device_type>& contextTypes, 
+			std::ostream& stream);
+		bool StartMetrics(int argc, char* argv[]);
+		bool ReadKernelFile(std::ostream& stream);
+		void RecordOperation(const std::string& name);
+		bool IsComparableWithSerial();
+		DeviceTask HalveBrightnessTask(DeviceScheduler& scheduler, size_t firstPixel, size_t numPixels);
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    private:
+		static void PrintStatistics(const ColorStatistics& statistics);
+		static double GetSecondsSince(std::chrono::steady_clock::time_point start);
+		static std::vector<cl_device_type> ParseTypes(const std::string& list);
+};
+
+#endif
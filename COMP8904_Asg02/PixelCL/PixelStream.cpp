@@ -0,0 +1,278 @@
+/*===================================================================================*//**
+	PixelStream
+	
+	Out-of-core processing of pixel files that do not fit in device or host memory, by 
+	streaming them through fixed-size windows.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see PixelStream
+	@see PixelStream.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "PixelStream.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Returns the window size in pixels: the requested size, or DEFAULT_WINDOW_PIXELS if 
+	zero, limited so one window fits in CL_DEVICE_MAX_MEM_ALLOC_SIZE and four fit in 
+	global memory. The result is a multiple of the local size.
+*/
+size_t PixelStream::GetWindowPixels(cl_device_id device, size_t requestedPixels, size_t localSize)
+{
+	cl_ulong maxAllocation = 0;
+	cl_ulong globalMemory = 0;
+	clGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(cl_ulong), &maxAllocation, NULL);
+	clGetDeviceInfo(device, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(cl_ulong), &globalMemory, NULL);
+
+	size_t windowPixels = (requestedPixels > 0) ? requestedPixels : DEFAULT_WINDOW_PIXELS;
+
+	if (maxAllocation > 0)
+	{
+		windowPixels = std::min(windowPixels, (size_t)(maxAllocation / sizeof(cl_float4)));
+	}
+
+	if (globalMemory > 0)
+	{
+		windowPixels = std::min(windowPixels, (size_t)(globalMemory / (4 * sizeof(cl_float4))));
+	}
+
+	windowPixels = (windowPixels / localSize) * localSize;
+	return std::max(windowPixels, localSize);
+}
+
+/**
+	Runs the kernel over every pixel in the input file and writes the results to the 
+	output file, a window at a time. The kernel takes the input and output buffers as 
+	arguments 0 and 1, which are left bound to the window buffers, so the kernel should 
+	not be shared with other callers. Returns the first OpenCL error hit, CL_INVALID_VALUE if a file 
+	cannot be opened or written or both paths name the same file, or CL_SUCCESS. A 
+	trailing partial pixel in the input is ignored.
+*/
+cl_int PixelStream::Process(
+	DeviceArena& arena, PixelBufferPool& pool, 
+	cl_command_queue commandQueue, cl_kernel kernel, 
+	const std::string& inputPath, const std::string& outputPath, 
+	size_t windowPixels, size_t localSize, 
+	StreamStatistics& statistics)
+{
+	statistics = StreamStatistics();
+	statistics.windowPixels = windowPixels;
+
+	/* Opening the output truncates it, which would empty the input before it is read. */
+	if (IsSameFile(inputPath, outputPath))
+	{
+		return CL_INVALID_VALUE;
+	}
+
+	std::ifstream input(inputPath, std::ios::in | std::ios::binary);
+	std::ofstream output(outputPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!input.is_open() || !output.is_open())
+	{
+		return CL_INVALID_VALUE;
+	}
+
+	/* Device windows are padded to whole work-groups, since the kernel has no bounds check. */
+	size_t devicePixels = ((windowPixels + localSize - 1) / localSize) * localSize;
+	cl_float4* hostInput[2] = { nullptr, nullptr };
+	cl_float4* hostOutput[2] = { nullptr, nullptr };
+	cl_mem deviceInput[2] = { nullptr, nullptr };
+	cl_mem deviceOutput[2] = { nullptr, nullptr };
+	cl_event finished[2] = { nullptr, nullptr };
+	size_t windowCount[2] = { 0, 0 };
+	cl_int result = CL_SUCCESS;
+
+	for (int i = 0; i < 2 && result == CL_SUCCESS; i++)
+	{
+		hostInput[i] = pool.Acquire(windowPixels);
+		hostOutput[i] = pool.Acquire(windowPixels);
+
+		if (!hostInput[i] || !hostOutput[i])
+		{
+			result = CL_OUT_OF_HOST_MEMORY;
+			break;
+		}
+
+		deviceInput[i] = arena.Allocate(sizeof(cl_float4) * devicePixels, &result);
+
+		if (result == CL_SUCCESS)
+		{
+			deviceOutput[i] = arena.Allocate(sizeof(cl_float4) * devicePixels, &result);
+		}
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int current = 0;
+
+	if (result == CL_SUCCESS)
+	{
+		windowCount[current] = ReadPixels(input, hostInput[current], windowPixels);
+	}
+
+	while (result == CL_SUCCESS && windowCount[current] > 0)
+	{
+		/* Queue this window: upload, kernel and download, finishing with one event. */
+		size_t bytes = sizeof(cl_float4) * windowCount[current];
+		size_t globalSize = ((windowCount[current] + localSize - 1) / localSize) * localSize;
+
+		result = clEnqueueWriteBuffer(
+			commandQueue, deviceInput[current],
+			CL_FALSE, 0,
+			bytes, hostInput[current],
+			0, NULL,
+			NULL
+		);
+
+		result |= clSetKernelArg(kernel, 0, sizeof(cl_mem), &deviceInput[current]);
+		result |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &deviceOutput[current]);
+
+		if (result == CL_SUCCESS)
+		{
+			result = clEnqueueNDRangeKernel(
+				commandQueue, kernel,
+				1, NULL,
+				&globalSize, &localSize,
+				0, NULL,
+				NULL
+			);
+		}
+
+		if (result == CL_SUCCESS)
+		{
+			result = clEnqueueReadBuffer(
+				commandQueue, deviceOutput[current],
+				CL_FALSE, 0,
+				bytes, hostOutput[current],
+				0, NULL,
+				&finished[current]
+			);
+		}
+
+		if (result != CL_SUCCESS)
+		{
+			break;
+		}
+
+		clFlush(commandQueue);
+
+		/* While the device works, write out the previous window and read the next one 
+		into its buffers, which the in-order queue is done with. */
+		int previous = 1 - current;
+
+		if (finished[previous])
+		{
+			result = clWaitForEvents(1, &finished[previous]);
+			clReleaseEvent(finished[previous]);
+			finished[previous] = nullptr;
+
+			output.write((const char*)hostOutput[previous], (std::streamsize)(sizeof(cl_float4) * windowCount[previous]));
+			statistics.pixels += windowCount[previous];
+			statistics.windows++;
+
+			if (result == CL_SUCCESS && !output)
+			{
+				result = CL_INVALID_VALUE;
+			}
+		}
+
+		if (result == CL_SUCCESS)
+		{
+			windowCount[previous] = ReadPixels(input, hostInput[previous], windowPixels);
+		}
+
+		current = previous;
+	}
+
+	/* Drain whatever is still in flight. */
+	clFinish(commandQueue);
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (finished[i])
+		{
+			if (result == CL_SUCCESS)
+			{
+				output.write((const char*)hostOutput[i], (std::streamsize)(sizeof(cl_float4) * windowCount[i]));
+				statistics.pixels += windowCount[i];
+				statistics.windows++;
+
+				if (!output)
+				{
+					result = CL_INVALID_VALUE;
+				}
+			}
+
+			clReleaseEvent(finished[i]);
+		}
+
+		arena.Free(deviceInput[i]);
+		arena.Free(deviceOutput[i]);
+		pool.Release(hostInput[i]);
+		pool.Release(hostOutput[i]);
+	}
+
+	statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+/**
+	Writes a file of random pixels, a million at a time, for trying out streaming. 
+	Returns false if the file cannot be written.
+*/
+bool PixelStream::GenerateFile(const std::string& path, unsigned long long numPixels, unsigned int seed)
+{
+	const size_t chunkPixels = 1000000;
+	std::ofstream output(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	std::minstd_rand generator(seed);
+	std::uniform_real_distribution<float> random0to1(0.0f, 1.0f);
+	std::vector<cl_float4> chunk;
+
+	for (unsigned long long written = 0; written < numPixels && output; written += chunk.size())
+	{
+		chunk.resize((size_t)std::min((unsigned long long)chunkPixels, numPixels - written));
+
+		for (cl_float4& eachPixel : chunk)
+		{
+			eachPixel = cl_float4{ random0to1(generator), random0to1(generator), random0to1(generator), random0to1(generator) };
+		}
+
+		output.write((const char*)chunk.data(), (std::streamsize)(sizeof(cl_float4) * chunk.size()));
+	}
+
+	return (bool)output;
+}
+
+/**
+	Returns whether the two paths name the same file, including through links or 
+	different spellings of the same path.
+*/
+bool PixelStream::IsSameFile(const std::string& firstPath, const std::string& secondPath)
+{
+	std::error_code error;
+	return firstPath == secondPath || std::filesystem::equivalent(firstPath, secondPath, error);
+}
+
+/**
+	Reads up to maxPixels whole pixels from the file. Returns how many were read, which 
+	is zero at the end of the file.
+*/
+size_t PixelStream::ReadPixels(std::ifstream& input, cl_float4* pixels, size_t maxPixels)
+{
+	input.read((char*)pixels, (std::streamsize)(maxPixels * sizeof(cl_float4)));
+	return (size_t)input.gcount() / sizeof(cl_float4);
+}
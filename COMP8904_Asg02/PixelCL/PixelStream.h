@@ -0,0 +1,84 @@
+/*===================================================================================*//**
+	PixelStream
+	
+	Out-of-core processing of pixel files that do not fit in device or host memory, by 
+	streaming them through fixed-size windows.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see PixelStream
+	@see PixelStream.cpp
+	
+*//*====================================================================================*/
+
+#ifndef PIXEL_STREAM_H
+#define PIXEL_STREAM_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <CL/cl.h>
+#include "DeviceArena.h"
+#include "PixelBufferPool.h"
+
+/*========================================================================================
+	Constants
+========================================================================================*/
+/** Window used when none is requested: 16M pixels, or 256 MB per buffer. */
+const size_t DEFAULT_WINDOW_PIXELS = 16 * 1024 * 1024;
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	Summary of a streamed run.
+*/
+struct StreamStatistics
+{
+	public:
+		unsigned long long pixels;
+		size_t windows;
+		size_t windowPixels;
+		double seconds;
+};
+
+/*========================================================================================
+	PixelStream	
+========================================================================================*/
+/**
+	Static class for streaming a raw file of cl_float4 pixels through a two-argument 
+	pixel kernel such as halveBrightness, writing the results to another file.
+	
+	Two windows are in flight. While the device works on one, the next is read from the 
+	input file and the previous result is written out. Memory use is four host windows 
+	and four device windows whatever the file size. Files are read in chunks rather than 
+	mapped, because mapped pages count towards the resident set.
+	
+	@see PixelStream.cpp
+*/
+class PixelStream
+{
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static size_t GetWindowPixels(cl_device_id device, size_t requestedPixels, size_t localSize);
+		static cl_int Process(
+			DeviceArena& arena, PixelBufferPool& pool, 
+			cl_command_queue commandQueue, cl_kernel kernel, 
+			const std::string& inputPath, const std::string& outputPath, 
+			size_t windowPixels, size_t localSize, 
+			StreamStatistics& statistics);
+		static bool GenerateFile(const std::string& path, unsigned long long numPixels, unsigned int seed);
+		static bool IsSameFile(const std::string& firstPath, const std::string& secondPath);
+
+    private:
+		static size_t ReadPixels(std::ifstream& input, cl_float4* pixels, size_t maxPixels);
+};
+
+#endif
@@ -0,0 +1,195 @@
+/*===================================================================================*//**
+	Roofline
+	
+	Achieved bandwidth and throughput of a kernel run, compared with measured peaks.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see Roofline
+	@see Roofline.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "Roofline.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+/*========================================================================================
+	Constants
+========================================================================================*/
+/** Elements in each triad array: three arrays of 32 MB, well past any last-level cache. */
+const size_t HOST_TRIAD_ELEMENTS = (size_t)4 * 1024 * 1024;
+
+/** Timed triad runs, after one warm-up run. The best is kept, as STREAM does. */
+const int HOST_TRIAD_RUNS = 5;
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates a roofline with no measured peaks.
+*/
+Roofline::Roofline() : 
+	_name(""), 
+	_peakGBs(0), 
+	_peakGFlops(0)
+{
+}
+
+/**
+	Creates a roofline from peaks measured elsewhere. A peak of 0 is unknown.
+*/
+Roofline::Roofline(const std::string& name, double peakGBs, double peakGFlops) : 
+	_name(name), 
+	_peakGBs(peakGBs), 
+	_peakGFlops(peakGFlops)
+{
+}
+
+/**
+	Returns whether the peak bandwidth is known.
+*/
+bool Roofline::IsMeasured() const
+{
+	return _peakGBs > 0;
+}
+
+/**
+	Returns the peak bandwidth in GB/s, or 0 if it is unknown.
+*/
+double Roofline::GetPeakGBs() const
+{
+	return _peakGBs;
+}
+
+/**
+	Returns the peak compute rate in GFLOP/s, or 0 if it is unknown.
+*/
+double Roofline::GetPeakGFlops() const
+{
+	return _peakGFlops;
+}
+
+/**
+	Writes the bandwidth and compute rate a run achieved moving the given bytes and 
+	doing the given FLOPs, and how close it came to the ceiling for its intensity.
+*/
+void Roofline::Report(std::ostream& stream, double bytes, double flops, double seconds) const
+{
+	if (seconds <= 0 || bytes <= 0)
+	{
+		return;
+	}
+
+	double gbs = bytes / seconds / 1e9;
+	double gflops = flops / seconds / 1e9;
+	double intensity = flops / bytes;
+
+	std::ios_base::fmtflags flags = stream.flags();
+	std::streamsize precision = stream.precision();
+	stream << std::fixed << std::setprecision(2) << 
+		"Achieved " << gbs << " GB/s and " << gflops << " GFLOP/s at " << 
+		std::setprecision(3) << intensity << " FLOP/byte";
+
+	if (!IsMeasured())
+	{
+		stream << ". No peak was measured for " << (_name.empty() ? "this device" : _name) << ".\n\n";
+	}
+	else if (_peakGFlops > 0 && _peakGFlops < intensity * _peakGBs)
+	{
+		stream << std::setprecision(1) << ", " << 
+			100.0 * gflops / _peakGFlops << "% of the " << _name << " compute peak of " << _peakGFlops << " GFLOP/s (compute bound).\n\n";
+	}
+	else
+	{
+		stream << std::setprecision(1) << ", " << 
+			100.0 * gbs / _peakGBs << "% of the " << _name << " peak of " << _peakGBs << " GB/s (memory bound, " << 
+			std::setprecision(2) << intensity * _peakGBs << " GFLOP/s attainable).\n\n";
+	}
+
+	stream.flags(flags);
+	stream.precision(precision);
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Measures the host's memory bandwidth with a STREAM triad. The host compute peak is 
+	not measured.
+*/
+Roofline Roofline::MeasureHost()
+{
+	return Roofline("host", MeasureHostTriad(), 0);
+}
+
+/**
+	Measures a device's bandwidth with the copy kernel, unless DeviceDatabase::Benchmark 
+	or a device profile has already done so. The compute peak comes from the device 
+	profile, and is unknown without one.
+*/
+Roofline Roofline::MeasureDevice(const DeviceInfo& info)
+{
+	double peakGBs = (info.bandwidthGBs > 0) ? info.bandwidthGBs : DeviceDatabase::MeasureCopyBandwidth(info);
+	return Roofline(info.name, peakGBs, info.profile.GetPeakGFlops());
+}
+
+/**
+	Runs the STREAM triad a[i] = b[i] + s * c[i] on every hardware thread and returns the 
+	best bandwidth in GB/s, counting two reads and one write per element.
+*/
+double Roofline::MeasureHostTriad()
+{
+	const double scalar = 3.0;
+	std::vector<double> a(HOST_TRIAD_ELEMENTS, 0.0);
+	std::vector<double> b(HOST_TRIAD_ELEMENTS, 1.0);
+	std::vector<double> c(HOST_TRIAD_ELEMENTS, 2.0);
+
+	size_t numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	size_t chunk = (HOST_TRIAD_ELEMENTS + numThreads - 1) / numThreads;
+	double bestSeconds = 0;
+
+	for (int run = 0; run <= HOST_TRIAD_RUNS; run++)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < numThreads; t++)
+		{
+			size_t first = std::min(t * chunk, HOST_TRIAD_ELEMENTS);
+			size_t last = std::min(first + chunk, HOST_TRIAD_ELEMENTS);
+			threads.push_back(std::thread([&a, &b, &c, scalar, first, last]()
+			{
+				for (size_t i = first; i < last; i++)
+				{
+					a[i] = b[i] + scalar * c[i];
+				}
+			}));
+		}
+		for (std::thread& eachThread : threads)
+		{
+			eachThread.join();
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (run > 0 && (bestSeconds == 0 || seconds < bestSeconds))
+		{
+			bestSeconds = seconds;
+		}
+	}
+
+	if (bestSeconds <= 0)
+	{
+		return 0;
+	}
+
+	return 3.0 * sizeof(double) * HOST_TRIAD_ELEMENTS / bestSeconds / 1e9;
+}
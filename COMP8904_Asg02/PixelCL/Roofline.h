@@ -0,0 +1,70 @@
+/*===================================================================================*//**
+	Roofline
+	
+	Achieved bandwidth and throughput of a kernel run, compared with measured peaks.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see Roofline
+	@see Roofline.cpp
+	
+*//*====================================================================================*/
+
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <ostream>
+#include <string>
+#include "DeviceDatabase.h"
+
+/*========================================================================================
+	Roofline	
+========================================================================================*/
+/**
+	The memory and compute ceilings of one device, and reports of how close runs on it 
+	come to them.
+	
+	A run that does F FLOPs over B bytes has an arithmetic intensity of F / B, and can 
+	reach at most intensity x peak bandwidth, or the compute peak if that is lower. 
+	Efficiency is the achieved rate as a percentage of that ceiling. The compute peak is 
+	optional; without one every run is treated as memory bound, which the pixel kernels 
+	are by a wide margin.
+	
+	@see Roofline.cpp
+*/
+class Roofline
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::string _name;
+		double _peakGBs;
+		double _peakGFlops;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		Roofline();
+		Roofline(const std::string& name, double peakGBs, double peakGFlops);
+		bool IsMeasured() const;
+		double GetPeakGBs() const;
+		double GetPeakGFlops() const;
+		void Report(std::ostream& stream, double bytes, double flops, double seconds) const;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static Roofline MeasureHost();
+		static Roofline MeasureDevice(const DeviceInfo& info);
+		static double MeasureHostTriad();
+};
+
+#endif
@@ -0,0 +1,276 @@
+/*===================================================================================*//**
+	RunConfig
+	
+	Problem size and launch settings read at run time from the command line, the 
+	environment or a config file, and checked against device limits.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see RunConfig
+	@see RunConfig.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "RunConfig.h"
+#include "CommandLine.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <ctime>
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates the default configuration: a million pixels through halveBrightness in 
+	work-groups of 64, once, on the best-scoring device. The seed is chosen by Load.
+*/
+RunConfig::RunConfig()
+	: numPixels(1000000), 
+	kernelName("halveBrightness"), 
+	localSize(64), 
+	device(""), 
+	iterations(1), 
+	seed(0), 
+	buildOptions("")
+{
+}
+
+/**
+	Reads the settings, loading the config file and then the workload file first if 
+	they are given. Returns false with a message in error if a file cannot be read or a 
+	value is not valid.
+*/
+bool RunConfig::Load(int argc, char* argv[], std::string& error)
+{
+	std::string configPath = CommandLine::GetOption(argc, argv, "--config", "PIXELCL_CONFIG");
+
+	if (!configPath.empty() && !CommandLine::LoadConfigFile(configPath))
+	{
+		error = "Could not read config file " + configPath + ".";
+		return false;
+	}
+
+	/* Loaded second, so the recorded values replace the config file's. */
+	std::string replayPath = CommandLine::GetOption(argc, argv, "--replay", "PIXELCL_REPLAY");
+
+	if (!replayPath.empty() && !CommandLine::LoadConfigFile(replayPath))
+	{
+		error = "Could not read workload file " + replayPath + ".";
+		return false;
+	}
+
+	unsigned long long count = 0;
+	std::string value = CommandLine::GetOption(argc, argv, "--pixels", "PIXELCL_PIXELS");
+
+	if (!value.empty())
+	{
+		if (!ParseCount(value, count) || count == 0)
+		{
+			error = "Invalid pixel count \"" + value + "\".";
+			return false;
+		}
+
+		numPixels = (size_t)count;
+	}
+
+	value = CommandLine::GetOption(argc, argv, "--local-size", "PIXELCL_LOCAL_SIZE");
+
+	if (!value.empty())
+	{
+		if (!ParseCount(value, count) || count == 0)
+		{
+			error = "Invalid local size \"" + value + "\".";
+			return false;
+		}
+
+		localSize = (size_t)count;
+	}
+
+	value = CommandLine::GetOption(argc, argv, "--iterations", "PIXELCL_ITERATIONS");
+
+	if (!value.empty())
+	{
+		if (!ParseCount(value, count) || count == 0 || count > INT_MAX)
+		{
+			error = "Invalid iteration count \"" + value + "\".";
+			return false;
+		}
+
+		iterations = (int)count;
+	}
+
+	value = CommandLine::GetOption(argc, argv, "--kernel", "PIXELCL_KERNEL");
+
+	if (!value.empty())
+	{
+		kernelName = value;
+	}
+
+	value = CommandLine::GetOption(argc, argv, "--seed", "PIXELCL_SEED");
+
+	if (!value.empty())
+	{
+		if (!ParseCount(value, count) || count > UINT32_MAX)
+		{
+			error = "Invalid seed \"" + value + "\".";
+			return false;
+		}
+
+		seed = (uint32_t)count;
+	}
+	else
+	{
+		seed = (uint32_t)time(nullptr);
+	}
+
+	device = CommandLine::GetOption(argc, argv, "--device", "PIXELCL_DEVICE");
+	buildOptions = CommandLine::GetOption(argc, argv, "--build-options", "PIXELCL_BUILD_OPTIONS");
+	return true;
+}
+
+/**
+	Checks the settings against a device and the pixel kernel built for it. The local 
+	size must fit the device and the kernel, and buffersPerDevice buffers of the padded 
+	pixel count must fit in memory. Returns false with a message in error otherwise.
+*/
+bool RunConfig::Validate(cl_device_id device, cl_kernel kernel, size_t buffersPerDevice, std::string& error) const
+{
+	RunLimits limits = RunLimits();
+	size_t maxWorkItemSizes[3] = { 0, 0, 0 };
+
+	cl_int result = clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(size_t), &limits.maxWorkGroupSize, NULL);
+	result |= clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_ITEM_SIZES, sizeof(maxWorkItemSizes), maxWorkItemSizes, NULL);
+	result |= clGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(cl_ulong), &limits.maxAllocation, NULL);
+	result |= clGetDeviceInfo(device, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(cl_ulong), &limits.globalMemory, NULL);
+	result |= clGetKernelWorkGroupInfo(kernel, device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t), &limits.kernelWorkGroupSize, NULL);
+
+	if (result != CL_SUCCESS)
+	{
+		error = "Could not query device limits.";
+		return false;
+	}
+
+	limits.maxWorkItemSize = maxWorkItemSizes[0];
+	return Validate(limits, buffersPerDevice, error);
+}
+
+/**
+	Checks the settings against limits already read from a device and its pixel kernel.
+*/
+bool RunConfig::Validate(const RunLimits& limits, size_t buffersPerDevice, std::string& error) const
+{
+	if (localSize > limits.maxWorkGroupSize || localSize > limits.maxWorkItemSize || localSize > limits.kernelWorkGroupSize)
+	{
+		error = "Local size " + std::to_string(localSize) + " is larger than the device allows (" + 
+			std::to_string(std::min(std::min(limits.maxWorkGroupSize, limits.maxWorkItemSize), limits.kernelWorkGroupSize)) + ").";
+		return false;
+	}
+
+	/* The statistics and batched kernels take pixel counts and offsets as cl_uint. */
+	if (numPixels > UINT_MAX)
+	{
+		error = "Pixel count " + std::to_string(numPixels) + " is more than the kernels can index.";
+		return false;
+	}
+
+	cl_ulong bufferSize = sizeof(cl_float4) * (cl_ulong)GetPaddedPixels();
+
+	if (bufferSize > limits.maxAllocation)
+	{
+		error = "A buffer of " + std::to_string(bufferSize >> 20) + " MB is larger than the device's largest allocation (" + 
+			std::to_string(limits.maxAllocation >> 20) + " MB). Use --input to stream it instead.";
+		return false;
+	}
+
+	if (bufferSize * buffersPerDevice > limits.globalMemory)
+	{
+		error = std::to_string(buffersPerDevice) + " buffers of " + std::to_string(bufferSize >> 20) + 
+			" MB do not fit in the device's " + std::to_string(limits.globalMemory >> 20) + " MB of global memory.";
+		return false;
+	}
+
+	return true;
+}
+
+/**
+	Returns the size in bytes of the host pixel buffers.
+*/
+size_t RunConfig::GetBufferSize() const
+{
+	return sizeof(cl_float4) * numPixels;
+}
+
+/**
+	Returns the pixel count rounded up to a whole number of work-groups. Device buffers 
+	are this big, because the pixel kernels do not check bounds.
+*/
+size_t RunConfig::GetPaddedPixels() const
+{
+	return ((numPixels + localSize - 1) / localSize) * localSize;
+}
+
+/**
+	Writes the settings in a readable form.
+*/
+void RunConfig::Print(std::ostream& stream) const
+{
+	stream << "Configuration:\n" << 
+		"\tPixels: " << numPixels << "\n" << 
+		"\tKernel: " << kernelName << "\n" << 
+		"\tLocal size: " << localSize << "\n" << 
+		"\tDevice: " << (device.empty() ? "best available" : device) << "\n" << 
+		"\tIterations: " << iterations << "\n" << 
+		"\tSeed: " << seed << "\n" << 
+		"\tBuild options: " << (buildOptions.empty() ? "none" : buildOptions) << "\n\n";
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Parses a whole number with an optional k, M or G suffix for thousands, millions or 
+	billions. Returns false if the text is not such a number.
+*/
+bool RunConfig::ParseCount(const std::string& text, unsigned long long& count)
+{
+	/* strtoull would accept signs and leading spaces, so insist on a digit first. */
+	if (text.empty() || text[0] < '0' || text[0] > '9')
+	{
+		return false;
+	}
+
+	char* end = nullptr;
+	count = std::strtoull(text.c_str(), &end, 10);
+
+	unsigned long long multiplier = 1;
+
+	switch (*end)
+	{
+		case 'k': case 'K':
+			multiplier = 1000ULL;
+			end++;
+			break;
+		case 'm': case 'M':
+			multiplier = 1000000ULL;
+			end++;
+			break;
+		case 'g': case 'G':
+			multiplier = 1000000000ULL;
+			end++;
+			break;
+	}
+
+	if (*end != '\0' || count > ULLONG_MAX / multiplier)
+	{
+		return false;
+	}
+
+	count *= multiplier;
+	return true;
+}
@@ -0,0 +1,98 @@
+/*===================================================================================*//**
+	RunConfig
+	
+	Problem size and launch settings read at run time from the command line, the 
+	environment or a config file, and checked against device limits.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see RunConfig
+	@see RunConfig.cpp
+	
+*//*====================================================================================*/
+
+#ifndef RUN_CONFIG_H
+#define RUN_CONFIG_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <CL/cl.h>
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	The limits of a device, and of the pixel kernel built for it, that a run must fit.
+*/
+struct RunLimits
+{
+	public:
+		size_t maxWorkGroupSize;
+		size_t maxWorkItemSize;
+		size_t kernelWorkGroupSize;
+		cl_ulong maxAllocation;
+		cl_ulong globalMemory;
+};
+
+/*========================================================================================
+	RunConfig	
+========================================================================================*/
+/**
+	Settings for one run.
+	
+	Each is read from "--name=value" on the command line, then a PIXELCL_ environment 
+	variable, then the workload file given with --replay or PIXELCL_REPLAY, then the 
+	config file given with --config or PIXELCL_CONFIG:
+	
+		--pixels        Number of pixels. Accepts k, M and G suffixes. Default 1M.
+		--kernel        Pixel kernel taking (input, output). Default halveBrightness. 
+		                Only halveBrightness is checked against the serial run.
+		--local-size    Work-group size for the pixel kernel. Default 64.
+		--device        Device override passed to DeviceDatabase::Select.
+		--iterations    Times to run the pixel kernel. Default 1.
+		--seed          Seed for the generated pixels. Default the current time.
+		--build-options Options passed to clBuildProgram. Default none.
+	
+	@see RunConfig.cpp
+*/
+class RunConfig
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    public:
+		size_t numPixels;
+		std::string kernelName;
+		size_t localSize;
+		std::string device;
+		int iterations;
+		uint32_t seed;
+		std::string buildOptions;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		RunConfig();
+		bool Load(int argc, char* argv[], std::string& error);
+		bool Validate(cl_device_id device, cl_kernel kernel, size_t buffersPerDevice, std::string& error) const;
+		bool Validate(const RunLimits& limits, size_t buffersPerDevice, std::string& error) const;
+		size_t GetBufferSize() const;
+		size_t GetPaddedPixels() const;
+		void Print(std::ostream& stream) const;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static bool ParseCount(const std::string& text, unsigned long long& count);
+};
+
+#endif
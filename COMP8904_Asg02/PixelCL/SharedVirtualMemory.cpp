@@ -0,0 +1,215 @@
+/*===================================================================================*//**
+	SharedVirtualMemory
+	
+	Runs the pixel kernel on pixels the host and device share through OpenCL 2.0 shared 
+	virtual memory, without staging them in buffers.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see SharedVirtualMemory
+	@see SharedVirtualMemory.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "SharedVirtualMemory.h"
+#include "Trace.h"
+#include <chrono>
+#include <cstring>
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Returns the most capable SVM mode the device supports. Devices older than OpenCL 2.0 
+	do not know CL_DEVICE_SVM_CAPABILITIES, and OpenCL 3.0 devices may report none, so 
+	both give SVM_NONE.
+*/
+SvmMode SharedVirtualMemory::GetMode(cl_device_id device)
+{
+	char version[128] = {};
+	clGetDeviceInfo(device, CL_DEVICE_VERSION, sizeof(version) - 1, version, NULL);
+
+	/* The version reads "OpenCL <major>.<minor> <vendor information>". */
+	if (std::strncmp(version, "OpenCL ", 7) != 0 || version[7] < '2' || version[7] > '9')
+	{
+		return SVM_NONE;
+	}
+
+	cl_device_svm_capabilities capabilities = 0;
+	if (clGetDeviceInfo(device, CL_DEVICE_SVM_CAPABILITIES, sizeof(capabilities), &capabilities, NULL) != CL_SUCCESS)
+	{
+		return SVM_NONE;
+	}
+
+	if (capabilities & CL_DEVICE_SVM_FINE_GRAIN_SYSTEM)
+	{
+		return SVM_FINE_GRAIN_SYSTEM;
+	}
+
+	if (capabilities & CL_DEVICE_SVM_FINE_GRAIN_BUFFER)
+	{
+		return SVM_FINE_GRAIN;
+	}
+
+	if (capabilities & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER)
+	{
+		return SVM_COARSE_GRAIN;
+	}
+
+	return SVM_NONE;
+}
+
+/**
+	Returns a readable name for an SVM mode.
+*/
+const char* SharedVirtualMemory::GetModeName(SvmMode mode)
+{
+	switch (mode)
+	{
+		case SVM_COARSE_GRAIN: return "coarse-grained buffer";
+		case SVM_FINE_GRAIN: return "fine-grained buffer";
+		case SVM_FINE_GRAIN_SYSTEM: return "fine-grained system";
+		default: return "none";
+	}
+}
+
+/**
+	Runs the pixel kernel over numPixels pixels in the given SVM mode, leaving the 
+	results in resultPixels. In SVM_FINE_GRAIN_SYSTEM the host arrays are passed to the 
+	kernel directly. Otherwise the pixels are copied into SVM allocations and the results 
+	copied out afterwards. seconds is set to the time from the start of the copy in until 
+	the results are in resultPixels, so that it compares fairly with the buffer path's 
+	upload, launch and read back. The kernel's arguments are changed, so it should not 
+	be shared with the buffer path.
+*/
+cl_int SharedVirtualMemory::Execute(
+	cl_context context, cl_command_queue queue, cl_kernel kernel, SvmMode mode, 
+	const cl_float4* pixels, cl_float4* resultPixels, size_t numPixels, size_t localSize, 
+	double* seconds)
+{
+	size_t size = sizeof(cl_float4) * numPixels;
+	*seconds = 0;
+
+	if (mode == SVM_NONE)
+	{
+		return CL_INVALID_OPERATION;
+	}
+
+	if (mode == SVM_FINE_GRAIN_SYSTEM)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		cl_int result = Launch(queue, kernel, pixels, resultPixels, numPixels, localSize);
+		*seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return result;
+	}
+
+	cl_svm_mem_flags flags = CL_MEM_READ_WRITE | ((mode == SVM_FINE_GRAIN) ? CL_MEM_SVM_FINE_GRAIN_BUFFER : 0);
+	cl_float4* sharedPixels = (cl_float4*)clSVMAlloc(context, flags, size, 0);
+	cl_float4* sharedResults = (cl_float4*)clSVMAlloc(context, flags, size, 0);
+	cl_int result = (sharedPixels && sharedResults) ? CL_SUCCESS : CL_OUT_OF_RESOURCES;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	/* Coarse-grained allocations must be mapped while the host writes to them. */
+	if (result == CL_SUCCESS && mode == SVM_COARSE_GRAIN)
+	{
+		result = clEnqueueSVMMap(queue, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, sharedPixels, size, 0, NULL, NULL);
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		std::memcpy(sharedPixels, pixels, size);
+	}
+
+	if (result == CL_SUCCESS && mode == SVM_COARSE_GRAIN)
+	{
+		result = clEnqueueSVMUnmap(queue, sharedPixels, 0, NULL, NULL);
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		result = Launch(queue, kernel, sharedPixels, sharedResults, numPixels, localSize);
+	}
+
+	if (result == CL_SUCCESS && mode == SVM_COARSE_GRAIN)
+	{
+		result = clEnqueueSVMMap(queue, CL_TRUE, CL_MAP_READ, sharedResults, size, 0, NULL, NULL);
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		std::memcpy(resultPixels, sharedResults, size);
+	}
+
+	if (result == CL_SUCCESS && mode == SVM_COARSE_GRAIN)
+	{
+		result = clEnqueueSVMUnmap(queue, sharedResults, 0, NULL, NULL);
+	}
+
+	*seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	/* clSVMFree does not wait for commands using the memory. */
+	clFinish(queue);
+	if (sharedPixels)
+	{
+		clSVMFree(context, sharedPixels);
+	}
+	if (sharedResults)
+	{
+		clSVMFree(context, sharedResults);
+	}
+
+	return result;
+}
+
+/**
+	Binds the shared arrays to the kernel and runs it over whole work-groups, then over 
+	the remaining pixels with a work-group size of the runtime's choosing, and waits 
+	for it to finish.
+*/
+cl_int SharedVirtualMemory::Launch(
+	cl_command_queue queue, cl_kernel kernel, 
+	const void* input, void* output, size_t numPixels, size_t localSize)
+{
+	cl_int result = clSetKernelArgSVMPointer(kernel, 0, input);
+	result |= clSetKernelArgSVMPointer(kernel, 1, output);
+
+	if (result != CL_SUCCESS)
+	{
+		return result;
+	}
+
+	size_t groupedPixels = (numPixels / localSize) * localSize;
+	size_t remainingPixels = numPixels - groupedPixels;
+
+	if (groupedPixels > 0)
+	{
+		TraceCommand kernelCommand("SVM kernel");
+		result = clEnqueueNDRangeKernel(
+			queue, kernel,
+			1, NULL,
+			&groupedPixels, &localSize,
+			0, NULL,
+			kernelCommand.GetEvent()
+		);
+	}
+
+	if (result == CL_SUCCESS && remainingPixels > 0)
+	{
+		TraceCommand tailCommand("SVM kernel tail");
+		result = clEnqueueNDRangeKernel(
+			queue, kernel,
+			1, &groupedPixels,
+			&remainingPixels, NULL,
+			0, NULL,
+			tailCommand.GetEvent()
+		);
+	}
+
+	cl_int finishResult = clFinish(queue);
+	return (result != CL_SUCCESS) ? result : finishResult;
+}
@@ -0,0 +1,76 @@
+/*===================================================================================*//**
+	SharedVirtualMemory
+	
+	Runs the pixel kernel on pixels the host and device share through OpenCL 2.0 shared 
+	virtual memory, without staging them in buffers.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see SharedVirtualMemory
+	@see SharedVirtualMemory.cpp
+	
+*//*====================================================================================*/
+
+#ifndef SHARED_VIRTUAL_MEMORY_H
+#define SHARED_VIRTUAL_MEMORY_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <cstddef>
+#include <CL/cl.h>
+
+/*========================================================================================
+	Enums
+========================================================================================*/
+/**
+	How a device can share memory with the host, from the least to the most capable.
+	
+	SVM_COARSE_GRAIN shares clSVMAlloc allocations, but the host must map them before 
+	touching them. SVM_FINE_GRAIN shares them without mapping. SVM_FINE_GRAIN_SYSTEM 
+	shares any host memory, so ordinary host buffers are passed to the kernel as they 
+	are. SVM_NONE is a device without SVM, such as any OpenCL 1.2 device.
+*/
+enum SvmMode
+{
+	SVM_NONE,
+	SVM_COARSE_GRAIN,
+	SVM_FINE_GRAIN,
+	SVM_FINE_GRAIN_SYSTEM
+};
+
+/*========================================================================================
+	SharedVirtualMemory	
+========================================================================================*/
+/**
+	Static class for running the pixel kernel through shared virtual memory.
+	
+	The most capable mode the device reports is used. The kernel is launched over whole 
+	work-groups and then once more over any remaining pixels, so the shared arrays need 
+	no padding. Every call returns an error rather than falling back, so the caller can 
+	run the buffer path instead.
+	
+	@see SharedVirtualMemory.cpp
+*/
+class SharedVirtualMemory
+{
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static SvmMode GetMode(cl_device_id device);
+		static const char* GetModeName(SvmMode mode);
+		static cl_int Execute(
+			cl_context context, cl_command_queue queue, cl_kernel kernel, SvmMode mode, 
+			const cl_float4* pixels, cl_float4* resultPixels, size_t numPixels, size_t localSize, 
+			double* seconds);
+
+    private:
+		static cl_int Launch(
+			cl_command_queue queue, cl_kernel kernel, 
+			const void* input, void* output, size_t numPixels, size_t localSize);
+};
+
+#endif
@@ -0,0 +1,221 @@
+/*===================================================================================*//**
+	SubmissionPool
+	
+	Command queues and kernel instances over one shared context and program, handed 
+	out so that many host threads can submit pixel work at once.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see SubmissionPool
+	@see SubmissionPool.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "SubmissionPool.h"
+#include "Trace.h"
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates an empty pool. Initialize must be called before Process.
+*/
+SubmissionPool::SubmissionPool() :
+	_context(nullptr),
+	_device(nullptr),
+	_program(nullptr),
+	_kernelName(""),
+	_localSize(0),
+	_maxSlots(0)
+{
+}
+
+/**
+	Releases every slot.
+*/
+SubmissionPool::~SubmissionPool()
+{
+	Release();
+}
+
+/**
+	Sets what the slots are created from: queues on the device in the context, and 
+	instances of the named kernel from the program, which must already be built. The 
+	pool does not take a reference to these, so they must outlive it. Submissions are 
+	padded to whole work-groups of localSize, and at most maxSlots run at once.
+*/
+void SubmissionPool::Initialize(
+	cl_context context, cl_device_id device, cl_program program, 
+	const std::string& kernelName, size_t localSize, size_t maxSlots)
+{
+	Release();
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_context = context;
+	_device = device;
+	_program = program;
+	_kernelName = kernelName;
+	_localSize = localSize;
+	_maxSlots = (maxSlots > 0) ? maxSlots : 1;
+}
+
+/**
+	Runs the pixel kernel over numPixels pixels, uploading them from pixels and reading 
+	the results back into resultPixels before returning. Safe to call from any number of 
+	threads at once.
+*/
+cl_int SubmissionPool::Process(const cl_float4* pixels, cl_float4* resultPixels, size_t numPixels)
+{
+	/* An empty range would enqueue a zero-sized launch, which OpenCL rejects. */
+	if (numPixels == 0)
+	{
+		return CL_SUCCESS;
+	}
+
+	cl_int result = CL_SUCCESS;
+	SubmissionSlot* slot = Acquire(&result);
+
+	if (!slot)
+	{
+		return result;
+	}
+
+	size_t globalSize = ((numPixels + _localSize - 1) / _localSize) * _localSize;
+	size_t size = sizeof(cl_float4) * numPixels;
+	result = Reserve(*slot, globalSize);
+
+	/* The arguments are bound to this slot's kernel, so no other thread can change them. */
+	if (result == CL_SUCCESS)
+	{
+		cl_mem input = slot->input;
+		cl_mem output = slot->output;
+		result = clSetKernelArg(slot->kernel, 0, sizeof(cl_mem), &input);
+		result |= clSetKernelArg(slot->kernel, 1, sizeof(cl_mem), &output);
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		TraceCommand writeCommand("Write submission");
+		result = clEnqueueWriteBuffer(slot->queue, slot->input, CL_FALSE, 0, size, pixels, 0, NULL, writeCommand.GetEvent());
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		TraceCommand kernelCommand(_kernelName.c_str());
+		result = clEnqueueNDRangeKernel(
+			slot->queue, slot->kernel,
+			1, NULL,
+			&globalSize, &_localSize,
+			0, NULL,
+			kernelCommand.GetEvent()
+		);
+	}
+
+	if (result == CL_SUCCESS)
+	{
+		TraceCommand readCommand("Read submission");
+		result = clEnqueueReadBuffer(slot->queue, slot->output, CL_TRUE, 0, size, resultPixels, 0, NULL, readCommand.GetEvent());
+	}
+
+	/* Leave nothing queued for the next submission to inherit. */
+	clFinish(slot->queue);
+	Return(slot);
+	return result;
+}
+
+/**
+	Returns the number of slots created so far, which is the most submissions that have 
+	run at once.
+*/
+size_t SubmissionPool::GetSlotCount()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _slots.size();
+}
+
+/**
+	Releases every slot. No submission may be running.
+*/
+void SubmissionPool::Release()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_idleSlots.clear();
+	_slots.clear();
+}
+
+/**
+	Takes an idle slot, creates one if there are fewer than maxSlots, or waits for one 
+	to be returned. Returns null with the error in result if a slot could not be 
+	created.
+*/
+SubmissionSlot* SubmissionPool::Acquire(cl_int* result)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_slotReturned.wait(lock, [this]() { return !_idleSlots.empty() || _slots.size() < _maxSlots; });
+
+	if (!_idleSlots.empty())
+	{
+		SubmissionSlot* slot = _idleSlots.back();
+		_idleSlots.pop_back();
+		return slot;
+	}
+
+	/* Creating queues and kernels is thread-safe, but the slot list is not. */
+	std::unique_ptr<SubmissionSlot> slot(new SubmissionSlot());
+	slot->capacity = 0;
+	slot->queue.Reset(clCreateCommandQueue(_context, _device, Trace::GetQueueProperties(), result));
+
+	if (*result == CL_SUCCESS)
+	{
+		slot->kernel.Reset(clCreateKernel(_program, _kernelName.c_str(), result));
+	}
+
+	if (*result != CL_SUCCESS)
+	{
+		return nullptr;
+	}
+
+	_slots.push_back(std::move(slot));
+	return _slots.back().get();
+}
+
+/**
+	Hands a slot back for the next submission.
+*/
+void SubmissionPool::Return(SubmissionSlot* slot)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_idleSlots.push_back(slot);
+	}
+	_slotReturned.notify_one();
+}
+
+/**
+	Grows a slot's buffers to hold at least paddedPixels pixels. Called only by the 
+	thread holding the slot.
+*/
+cl_int SubmissionPool::Reserve(SubmissionSlot& slot, size_t paddedPixels)
+{
+	if (slot.capacity >= paddedPixels)
+	{
+		return CL_SUCCESS;
+	}
+
+	cl_int result = CL_SUCCESS;
+	size_t size = sizeof(cl_float4) * paddedPixels;
+	slot.input.Reset(clCreateBuffer(_context, CL_MEM_READ_ONLY, size, NULL, &result));
+
+	if (result == CL_SUCCESS)
+	{
+		slot.output.Reset(clCreateBuffer(_context, CL_MEM_WRITE_ONLY, size, NULL, &result));
+	}
+
+	slot.capacity = (result == CL_SUCCESS) ? paddedPixels : 0;
+	return result;
+}
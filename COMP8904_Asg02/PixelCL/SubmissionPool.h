@@ -0,0 +1,103 @@
+/*===================================================================================*//**
+	SubmissionPool
+	
+	Command queues and kernel instances over one shared context and program, handed 
+	out so that many host threads can submit pixel work at once.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see SubmissionPool
+	@see SubmissionPool.cpp
+	
+*//*====================================================================================*/
+
+#ifndef SUBMISSION_POOL_H
+#define SUBMISSION_POOL_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <CL/cl.h>
+#include "ClHandle.h"
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	Everything one submission needs to itself: a queue, an instance of the pixel kernel 
+	and a pair of device buffers, grown to the largest submission made with them.
+*/
+struct SubmissionSlot
+{
+	public:
+		ClCommandQueue queue;
+		ClKernel kernel;
+		ClMem input;
+		ClMem output;
+		size_t capacity;
+};
+
+/*========================================================================================
+	SubmissionPool
+========================================================================================*/
+/**
+	Thread-safe pool of submission slots.
+	
+	clSetKernelArg is the one OpenCL call that is not safe on a kernel shared between 
+	threads, so threads submitting through one kernel and queue have to take turns. 
+	Here each submission takes a slot of its own for as long as it runs, binds its 
+	arguments to that slot's kernel and enqueues on that slot's queue. Slots are created 
+	the first time they are needed, up to maxSlots, and kept for later submissions; when 
+	all of them are busy a submission waits for one to come back. The context and 
+	program are shared and only read.
+	
+	@see SubmissionPool.cpp
+*/
+class SubmissionPool
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::mutex _mutex;
+		std::condition_variable _slotReturned;
+		cl_context _context;
+		cl_device_id _device;
+		cl_program _program;
+		std::string _kernelName;
+		size_t _localSize;
+		size_t _maxSlots;
+		std::vector<std::unique_ptr<SubmissionSlot>> _slots;
+		std::vector<SubmissionSlot*> _idleSlots;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		SubmissionPool();
+		~SubmissionPool();
+		SubmissionPool(const SubmissionPool&) = delete;
+		SubmissionPool& operator=(const SubmissionPool&) = delete;
+
+		void Initialize(
+			cl_context context, cl_device_id device, cl_program program, 
+			const std::string& kernelName, size_t localSize, size_t maxSlots);
+		cl_int Process(const cl_float4* pixels, cl_float4* resultPixels, size_t numPixels);
+		size_t GetSlotCount();
+		void Release();
+
+    private:
+		SubmissionSlot* Acquire(cl_int* result);
+		void Return(SubmissionSlot* slot);
+		cl_int Reserve(SubmissionSlot& slot, size_t paddedPixels);
+};
+
+#endif
@@ -0,0 +1,376 @@
+/*===================================================================================*//**
+	Trace
+	
+	Timeline of host spans and device commands, written as Chrome trace JSON. Compiled 
+	in only when PIXELCL_TRACE is defined.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see Trace
+	@see Trace.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "Trace.h"
+
+#ifdef PIXELCL_TRACE
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/*========================================================================================
+	Structs
+========================================================================================*/
+/**
+	One complete event on the timeline, in microseconds since the trace started.
+*/
+struct TraceRecord
+{
+	public:
+		std::string name;
+		int pid;
+		int tid;
+		double start;
+		double duration;
+};
+
+/**
+	A device command whose profiling info is read when the trace is written.
+*/
+struct PendingCommand
+{
+	public:
+		std::string name;
+		int tid;
+		double enqueueTime;
+		cl_event event;
+};
+
+/**
+	Everything recorded since Start. Only touched with the mutex held.
+*/
+struct TraceLog
+{
+	public:
+		std::mutex mutex;
+		std::string path;
+		std::chrono::steady_clock::time_point start;
+		std::vector<TraceRecord> records;
+		std::vector<PendingCommand> commands;
+		std::map<cl_command_queue, int> queueTracks;
+		std::vector<std::string> queueNames;
+		int numThreads;
+};
+
+/*----------------------------------------------------------------------------------------
+	Class Fields
+----------------------------------------------------------------------------------------*/
+/* The log is never freed, so it outlives runtimes destroyed during static destruction. */
+std::atomic<bool> Trace::_isRecording(false);
+TraceLog* Trace::_log = nullptr;
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Starts recording, to be written to the given path by Stop. Returns false if a trace 
+	is already being recorded.
+*/
+bool Trace::Start(const std::string& path)
+{
+	if (!_log)
+	{
+		_log = new TraceLog();
+		_log->numThreads = 0;
+	}
+
+	std::lock_guard<std::mutex> lock(_log->mutex);
+
+	if (_isRecording)
+	{
+		return false;
+	}
+
+	_log->path = path;
+	_log->start = std::chrono::steady_clock::now();
+	_log->records.clear();
+	_log->commands.clear();
+	_log->queueTracks.clear();
+	_log->queueNames.clear();
+	_isRecording = true;
+	return true;
+}
+
+/**
+	Stops recording, waits for the recorded device commands, and writes the trace. 
+	Returns false if the file could not be written. Must be called before the command 
+	queues are released.
+*/
+bool Trace::Stop()
+{
+	if (!_isRecording)
+	{
+		return true;
+	}
+
+	_isRecording = false;
+	std::lock_guard<std::mutex> lock(_log->mutex);
+
+	/* Place each command relative to when the host enqueued it. */
+	for (const PendingCommand& eachCommand : _log->commands)
+	{
+		cl_ulong queued = 0;
+		cl_ulong start = 0;
+		cl_ulong end = 0;
+
+		cl_int result = clWaitForEvents(1, &eachCommand.event);
+		result |= clGetEventProfilingInfo(eachCommand.event, CL_PROFILING_COMMAND_QUEUED, sizeof(cl_ulong), &queued, NULL);
+		result |= clGetEventProfilingInfo(eachCommand.event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &start, NULL);
+		result |= clGetEventProfilingInfo(eachCommand.event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &end, NULL);
+		clReleaseEvent(eachCommand.event);
+
+		if (result == CL_SUCCESS && start >= queued && end >= start)
+		{
+			TraceRecord record = { eachCommand.name, 2, eachCommand.tid,
+				eachCommand.enqueueTime + (start - queued) / 1000.0, (end - start) / 1000.0 };
+			_log->records.push_back(record);
+		}
+	}
+	_log->commands.clear();
+
+	std::ofstream file(_log->path);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	file << "{\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Host\"}},\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"Devices\"}}";
+
+	for (size_t i = 0; i < _log->queueNames.size(); i++)
+	{
+		file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":" << i << 
+			",\"args\":{\"name\":\"" << Escape(_log->queueNames[i]) << "\"}}";
+	}
+
+	char times[64];
+	for (const TraceRecord& eachRecord : _log->records)
+	{
+		std::snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f", eachRecord.start, eachRecord.duration);
+		file << ",\n{\"name\":\"" << Escape(eachRecord.name) << "\",\"ph\":\"X\",\"pid\":" << eachRecord.pid << 
+			",\"tid\":" << eachRecord.tid << "," << times << "}";
+	}
+
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	_log->records.clear();
+	return (bool)file;
+}
+
+/**
+	Returns whether a trace is being recorded.
+*/
+bool Trace::IsRecording()
+{
+	return _isRecording;
+}
+
+/**
+	Returns the time in microseconds since the trace started.
+*/
+double Trace::Now()
+{
+	if (!_log)
+	{
+		return 0;
+	}
+
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - _log->start).count();
+}
+
+/**
+	Records a host span on the calling thread's track.
+*/
+void Trace::AddSpan(const char* name, double start, double end)
+{
+	if (!_isRecording)
+	{
+		return;
+	}
+
+	int tid = GetThreadTrack();
+	std::lock_guard<std::mutex> lock(_log->mutex);
+	TraceRecord record = { name, 1, tid, start, end - start };
+	_log->records.push_back(record);
+}
+
+/**
+	Records a device command, taking over the reference to its event. The queue the 
+	command was enqueued on must have profiling enabled.
+*/
+void Trace::AddCommand(const char* name, cl_event event, double enqueueTime)
+{
+	if (!_isRecording)
+	{
+		clReleaseEvent(event);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_log->mutex);
+	PendingCommand command = { name, GetQueueTrack(event), enqueueTime, event };
+	_log->commands.push_back(command);
+}
+
+/**
+	Returns the properties command queues need for their commands to be traced: 
+	profiling while a trace is being recorded, and none otherwise.
+*/
+cl_command_queue_properties Trace::GetQueueProperties()
+{
+	return _isRecording ? CL_QUEUE_PROFILING_ENABLE : 0;
+}
+
+/**
+	Returns a small, stable track number for the calling thread.
+*/
+int Trace::GetThreadTrack()
+{
+	thread_local int track = -1;
+
+	if (track < 0)
+	{
+		std::lock_guard<std::mutex> lock(_log->mutex);
+		track = _log->numThreads++;
+	}
+
+	return track;
+}
+
+/**
+	Returns the track for the queue an event was enqueued on, naming new tracks after 
+	their device. The log's mutex must be held.
+*/
+int Trace::GetQueueTrack(cl_event event)
+{
+	cl_command_queue queue = nullptr;
+	clGetEventInfo(event, CL_EVENT_COMMAND_QUEUE, sizeof(cl_command_queue), &queue, NULL);
+
+	std::map<cl_command_queue, int>::iterator found = _log->queueTracks.find(queue);
+
+	if (found != _log->queueTracks.end())
+	{
+		return found->second;
+	}
+
+	cl_device_id device = nullptr;
+	char deviceName[256] = "";
+	clGetCommandQueueInfo(queue, CL_QUEUE_DEVICE, sizeof(cl_device_id), &device, NULL);
+	clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(deviceName) - 1, deviceName, NULL);
+
+	int track = (int)_log->queueNames.size();
+	_log->queueTracks[queue] = track;
+	_log->queueNames.push_back("Queue " + std::to_string(track) + ": " + deviceName);
+	return track;
+}
+
+/**
+	Escapes text for use in a JSON string.
+*/
+std::string Trace::Escape(const std::string& text)
+{
+	std::string escaped;
+
+	for (char eachChar : text)
+	{
+		if (eachChar == '"' || eachChar == '\\')
+		{
+			escaped += '\\';
+			escaped += eachChar;
+		}
+		else if ((unsigned char)eachChar < 0x20)
+		{
+			escaped += ' ';
+		}
+		else
+		{
+			escaped += eachChar;
+		}
+	}
+
+	return escaped;
+}
+
+/*----------------------------------------------------------------------------------------
+	TraceSpan
+----------------------------------------------------------------------------------------*/
+/**
+	Starts the span if a trace is being recorded.
+*/
+TraceSpan::TraceSpan(const char* name) :
+	_name(name),
+	_start(Trace::IsRecording() ? Trace::Now() : -1)
+{
+}
+
+/**
+	Ends the span if End was not called.
+*/
+TraceSpan::~TraceSpan()
+{
+	End();
+}
+
+/**
+	Records the span up to now. Later calls do nothing.
+*/
+void TraceSpan::End()
+{
+	if (_start >= 0)
+	{
+		Trace::AddSpan(_name, _start, Trace::Now());
+		_start = -1;
+	}
+}
+
+/*----------------------------------------------------------------------------------------
+	TraceCommand
+----------------------------------------------------------------------------------------*/
+/**
+	Notes the enqueue time of a command about to be enqueued.
+*/
+TraceCommand::TraceCommand(const char* name) :
+	_name(name),
+	_enqueueTime(Trace::Now()),
+	_event(nullptr)
+{
+}
+
+/**
+	Hands the command's event to Trace, if one was returned.
+*/
+TraceCommand::~TraceCommand()
+{
+	if (_event)
+	{
+		Trace::AddCommand(_name, _event, _enqueueTime);
+	}
+}
+
+/**
+	Returns where the enqueue call should store the command's event, or null if no 
+	trace is being recorded.
+*/
+cl_event* TraceCommand::GetEvent()
+{
+	return Trace::IsRecording() ? &_event : nullptr;
+}
+#endif
@@ -0,0 +1,152 @@
+/*===================================================================================*//**
+	Trace
+	
+	Timeline of host spans and device commands, written as Chrome trace JSON. Compiled 
+	in only when PIXELCL_TRACE is defined.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see Trace
+	@see Trace.cpp
+	
+*//*====================================================================================*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <atomic>
+#include <string>
+#include <CL/cl.h>
+
+/*========================================================================================
+	Trace
+========================================================================================*/
+struct TraceLog;
+
+/**
+	Static class recording what the host and the devices did during a run, for viewing 
+	in chrome://tracing or ui.perfetto.dev.
+	
+	Host spans are timed on the steady clock and shown on one track per thread. Device 
+	commands are timed from their cl_event profiling info and shown on one track per 
+	command queue, so their queues must be created with GetQueueProperties. Device 
+	clocks do not share the host's epoch, so each command is placed relative to the 
+	host time at which it was enqueued.
+	
+	Nothing is recorded until Start is called. Without PIXELCL_TRACE every method is an 
+	empty inline function, so tracing compiles to nothing.
+	
+	@see Trace.cpp
+*/
+class Trace
+{
+    /*------------------------------------------------------------------------------------
+		Class Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		static std::atomic<bool> _isRecording;
+		static TraceLog* _log;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static bool Start(const std::string& path);
+		static bool Stop();
+		static bool IsRecording();
+		static double Now();
+		static void AddSpan(const char* name, double start, double end);
+		static void AddCommand(const char* name, cl_event event, double enqueueTime);
+		static cl_command_queue_properties GetQueueProperties();
+
+    private:
+		static int GetThreadTrack();
+		static int GetQueueTrack(cl_event event);
+		static std::string Escape(const std::string& text);
+};
+
+/*========================================================================================
+	TraceSpan
+========================================================================================*/
+/**
+	Records a host span from its construction until End is called or it goes out of 
+	scope, whichever comes first.
+*/
+class TraceSpan
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		const char* _name;
+		double _start;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		explicit TraceSpan(const char* name);
+		~TraceSpan();
+		TraceSpan(const TraceSpan&) = delete;
+		TraceSpan& operator=(const TraceSpan&) = delete;
+
+		void End();
+};
+
+/*========================================================================================
+	TraceCommand
+========================================================================================*/
+/**
+	Records one device command. Pass GetEvent as the event argument of the enqueue call; 
+	the event is handed to Trace when the TraceCommand goes out of scope, and its 
+	profiling info is read when the trace is written.
+*/
+class TraceCommand
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		const char* _name;
+		double _enqueueTime;
+		cl_event _event;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		explicit TraceCommand(const char* name);
+		~TraceCommand();
+		TraceCommand(const TraceCommand&) = delete;
+		TraceCommand& operator=(const TraceCommand&) = delete;
+
+		cl_event* GetEvent();
+};
+
+/*========================================================================================
+	Disabled Tracing
+========================================================================================*/
+#ifndef PIXELCL_TRACE
+inline bool Trace::Start(const std::string&) { return false; }
+inline bool Trace::Stop() { return true; }
+inline bool Trace::IsRecording() { return false; }
+inline double Trace::Now() { return 0; }
+inline void Trace::AddSpan(const char*, double, double) {}
+inline void Trace::AddCommand(const char*, cl_event, double) {}
+inline cl_command_queue_properties Trace::GetQueueProperties() { return 0; }
+
+inline TraceSpan::TraceSpan(const char*) {}
+inline TraceSpan::~TraceSpan() {}
+inline void TraceSpan::End() {}
+
+inline TraceCommand::TraceCommand(const char*) {}
+inline TraceCommand::~TraceCommand() {}
+inline cl_event* TraceCommand::GetEvent() { return nullptr; }
+#endif
+
+#endif
@@ -0,0 +1,159 @@
+/*===================================================================================*//**
+	WorkloadCapture
+	
+	Records the settings, device selection and operations of a run to a workload file 
+	that can be replayed.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see WorkloadCapture
+	@see WorkloadCapture.h
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include "WorkloadCapture.h"
+#include <fstream>
+#include <sstream>
+
+/*----------------------------------------------------------------------------------------
+	Instance Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Creates a capture that records nothing until it is started.
+*/
+WorkloadCapture::WorkloadCapture() :
+	_path("")
+{
+}
+
+/**
+	Starts recording to the given path, forgetting anything recorded before. An empty 
+	path stops recording.
+*/
+void WorkloadCapture::Start(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_path = path;
+	_settings.clear();
+	_operations.clear();
+}
+
+/**
+	Returns whether a workload is being recorded.
+*/
+bool WorkloadCapture::IsCapturing() const
+{
+	return !_path.empty();
+}
+
+/**
+	Returns the path of the workload file, or an empty string if none is being recorded.
+*/
+const std::string& WorkloadCapture::GetPath() const
+{
+	return _path;
+}
+
+/**
+	Records a setting by its option name without the leading dashes, replacing any 
+	value recorded for it before. Settings are written in the order they were first set.
+*/
+void WorkloadCapture::Set(const std::string& name, const std::string& value)
+{
+	if (!IsCapturing())
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (std::pair<std::string, std::string>& eachSetting : _settings)
+	{
+		if (eachSetting.first == name)
+		{
+			eachSetting.second = value;
+			return;
+		}
+	}
+
+	_settings.push_back(std::make_pair(name, value));
+}
+
+/**
+	Records that an operation ran and rewrites the workload file. Returns false if it 
+	could not be written.
+*/
+bool WorkloadCapture::AddOperation(const std::string& name)
+{
+	if (!IsCapturing())
+	{
+		return true;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_operations.push_back(name);
+	return Write();
+}
+
+/**
+	Writes the settings and operations recorded so far, replacing the workload file. 
+	Returns false if it could not be written.
+*/
+bool WorkloadCapture::Save() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return Write();
+}
+
+/**
+	Writes the workload file. The mutex must be held.
+*/
+bool WorkloadCapture::Write() const
+{
+	std::ofstream file(_path);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file << "# Workload recorded by WorkloadCapture. Replay it with PixelReplay --replay=" << _path << ".\n";
+
+	for (const std::pair<std::string, std::string>& eachSetting : _settings)
+	{
+		file << eachSetting.first << " = " << eachSetting.second << "\n";
+	}
+
+	file << "operations =";
+	for (const std::string& eachOperation : _operations)
+	{
+		file << " " << eachOperation;
+	}
+	file << "\n";
+
+	return (bool)file;
+}
+
+/*----------------------------------------------------------------------------------------
+	Class Methods
+----------------------------------------------------------------------------------------*/
+/**
+	Splits a recorded list, such as the operations, into its words.
+*/
+std::vector<std::string> WorkloadCapture::SplitList(const std::string& list)
+{
+	std::vector<std::string> words;
+	std::istringstream stream(list);
+	std::string eachWord;
+
+	while (stream >> eachWord)
+	{
+		words.push_back(eachWord);
+	}
+
+	return words;
+}
@@ -0,0 +1,76 @@
+/*===================================================================================*//**
+	WorkloadCapture
+	
+	Records the settings, device selection and operations of a run to a workload file 
+	that can be replayed.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+	@see WorkloadCapture
+	@see WorkloadCapture.cpp
+	
+*//*====================================================================================*/
+
+#ifndef WORKLOAD_CAPTURE_H
+#define WORKLOAD_CAPTURE_H
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*========================================================================================
+	WorkloadCapture
+========================================================================================*/
+/**
+	Records what a run did, so the same workload can be run again on another build or 
+	device.
+	
+	The workload file holds "name = value" lines in the config file format, so replaying 
+	it is a matter of loading it with --replay: every recorded setting is used unless it 
+	is given again on the command line or in the environment. The pixels are recorded as 
+	their seed, and the operations in the order they ran. The file is rewritten after 
+	each operation, so a run that crashes still leaves a workload behind. Settings can 
+	be recorded from more than one thread.
+	
+	@see WorkloadCapture.cpp
+*/
+class WorkloadCapture
+{
+    /*------------------------------------------------------------------------------------
+		Instance Fields
+    ------------------------------------------------------------------------------------*/
+    private:
+		std::string _path;
+		std::vector<std::pair<std::string, std::string>> _settings;
+		std::vector<std::string> _operations;
+		mutable std::mutex _mutex;
+
+	/*------------------------------------------------------------------------------------
+		Instance Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		WorkloadCapture();
+		void Start(const std::string& path);
+		bool IsCapturing() const;
+		const std::string& GetPath() const;
+		void Set(const std::string& name, const std::string& value);
+		bool AddOperation(const std::string& name);
+		bool Save() const;
+
+    private:
+		bool Write() const;
+
+	/*------------------------------------------------------------------------------------
+		Class Methods
+	------------------------------------------------------------------------------------*/
+    public:
+		static std::vector<std::string> SplitList(const std::string& list);
+};
+
+#endif
@@ -0,0 +1,56 @@
+/*===================================================================================*//**
+	PixelReplay
+	
+	Runs a workload recorded by one of the parts with --capture again, on the same 
+	device or another one.
+
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <iostream>
+#include "CommandLine.h"
+#include "PixelRuntime.h"
+
+/*========================================================================================
+	Fields
+========================================================================================*/
+PixelRuntime _runtime;
+
+/*========================================================================================
+	Main Function
+========================================================================================*/
+/**
+	Replays the workload file given with --replay or PIXELCL_REPLAY. Other options are 
+	the same as the parts', and replace the recorded ones.
+*/
+int main(int argc, char* argv[])
+{
+	if (CommandLine::GetOption(argc, argv, "--replay", "PIXELCL_REPLAY").empty())
+	{
+		std::cout << "Usage: PixelReplay --replay=<workload file> [options]\n\n";
+		return 1;
+	}
+
+	/* Read the recorded settings. */
+	if (!_runtime.Configure(argc, argv))
+	{
+		return 1;
+	}
+
+	if (!_runtime.Replay(argc, argv))
+	{
+		return 1;
+	}
+
+	std::cout << "Replay finished successfully!\n\n";
+
+	_runtime.CleanUpCl();
+
+	return 0;
+}
@@ -0,0 +1,374 @@
+/*===================================================================================*//**
+	PixelTests
+	
+	Unit tests of the PixelCL pieces that do not need an OpenCL device, run by CTest.
+	
+    @author Erick Fernandez de Arteaga, John Janzen
+	@version 0.0.0
+	@file
+	
+*//*====================================================================================*/
+
+/*========================================================================================
+	Dependencies
+========================================================================================*/
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <CL/cl.h>
+#include "ColorStatistics.h"
+#include "CommandGraph.h"
+#include "CommandLine.h"
+#include "DeviceArena.h"
+#include "Metrics.h"
+#include "Pixel.h"
+#include "RunConfig.h"
+#include "WorkloadCapture.h"
+
+/*========================================================================================
+	Fields
+========================================================================================*/
+int _failures = 0;
+
+/*========================================================================================
+	Helpers
+========================================================================================*/
+/**
+	Counts and reports a failed check. Returns the condition, so a test can stop early.
+*/
+bool Check(bool condition, const std::string& description)
+{
+	if (!condition)
+	{
+		std::cout << "FAILED: " << description << "\n";
+		_failures++;
+	}
+
+	return condition;
+}
+
+/**
+	Returns whether two values agree to within a relative tolerance.
+*/
+bool IsClose(double a, double b, double tolerance)
+{
+	return std::fabs(a - b) <= tolerance * std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+}
+
+/*========================================================================================
+	Tests
+========================================================================================*/
+/**
+	Records one value and a much larger one, so the median is the top of the first 
+	value's bucket, and checks the bucket bounds against the documented 12.5% error.
+*/
+void TestMetricHistogram()
+{
+	const uint64_t large = 1000000000000ULL;
+
+	/* Values below 16 have a bucket each. */
+	for (uint64_t value = 0; value < 2 * HISTOGRAM_SUB_BUCKETS; value++)
+	{
+		MetricHistogram histogram;
+		histogram.Record(value);
+		histogram.Record(large);
+		Check(histogram.GetQuantile(0.5) == value, "histogram bucket of " + std::to_string(value) + " is exact");
+	}
+
+	const uint64_t expected[][2] = { { 16, 17 }, { 17, 17 }, { 18, 19 }, { 100, 103 }, { 1000, 1023 }, { 1024, 1151 } };
+	for (const uint64_t* eachCase : expected)
+	{
+		MetricHistogram histogram;
+		histogram.Record(eachCase[0]);
+		histogram.Record(large);
+		Check(histogram.GetQuantile(0.5) == eachCase[1],
+			"histogram bucket of " + std::to_string(eachCase[0]) + " tops out at " + std::to_string(eachCase[1]));
+	}
+
+	for (uint64_t value = 16; value < large; value = value * 3 + 1)
+	{
+		MetricHistogram histogram;
+		histogram.Record(value);
+		histogram.Record(large * 10);
+		uint64_t limit = histogram.GetQuantile(0.5);
+		Check(limit >= value && limit - value <= value / HISTOGRAM_SUB_BUCKETS,
+			"histogram bucket of " + std::to_string(value) + " is within 12.5%");
+	}
+
+	/* Quantiles never report more than the largest value seen, and the extremes fit. */
+	MetricHistogram histogram;
+	histogram.Record(100);
+	Check(histogram.GetQuantile(0.99) == 100, "histogram quantile is capped at the maximum");
+	histogram.Record(UINT64_MAX);
+	Check(histogram.GetCount() == 2 && histogram.GetMax() == UINT64_MAX, "histogram records the largest 64-bit value");
+	Check(MetricHistogram().GetQuantile(0.5) == 0, "empty histogram reports 0");
+
+	MetricHistogram seconds;
+	seconds.RecordSeconds(0.0025);
+	Check(seconds.GetSum() == 2500, "histogram records seconds as microseconds");
+}
+
+/**
+	Checks that size classes are exact up to four alignment units, never round down, 
+	waste at most a fifth, and grow with the request.
+*/
+void TestDeviceArenaSizeClass()
+{
+	const size_t alignment = 128;
+	Check(DeviceArena::GetSizeClass(0, alignment) == alignment, "size class of 0 is one unit");
+	Check(DeviceArena::GetSizeClass(1, alignment) == alignment, "size class of 1 is one unit");
+	Check(DeviceArena::GetSizeClass(4 * alignment, alignment) == 4 * alignment, "size class of four units is exact");
+	Check(DeviceArena::GetSizeClass(5 * alignment, alignment) == 5 * alignment, "size class of five units is exact");
+	Check(DeviceArena::GetSizeClass(9 * alignment, alignment) == 10 * alignment, "size class of nine units is ten");
+	Check(DeviceArena::GetSizeClass(17 * alignment, alignment) == 20 * alignment, "size class of 17 units is 20");
+
+	size_t previous = 0;
+	for (size_t bytes = 1; bytes < ((size_t)1 << 32); bytes = bytes * 5 / 4 + 37)
+	{
+		size_t sizeClass = DeviceArena::GetSizeClass(bytes, alignment);
+
+		if (!Check(sizeClass >= bytes && sizeClass % alignment == 0, "size class of " + std::to_string(bytes) + " holds it") ||
+			!Check(sizeClass - bytes < alignment || (sizeClass - bytes) * 5 <= sizeClass, "size class of " + std::to_string(bytes) + " wastes at most a fifth") ||
+			!Check(sizeClass >= previous, "size class of " + std::to_string(bytes) + " is not smaller than the one before"))
+		{
+			return;
+		}
+
+		previous = sizeClass;
+	}
+}
+
+/**
+	Checks counts with and without suffixes, and the text ParseCount must reject.
+*/
+void TestRunConfigParseCount()
+{
+	const std::pair<const char*, unsigned long long> valid[] = {
+		{ "0", 0 }, { "64", 64 }, { "2k", 2000 }, { "2K", 2000 }, { "16M", 16000000 }, { "1G", 1000000000 },
+		{ "18446744073709551615", ULLONG_MAX } };
+
+	for (const std::pair<const char*, unsigned long long>& eachCase : valid)
+	{
+		unsigned long long count = 0;
+		Check(RunConfig::ParseCount(eachCase.first, count) && count == eachCase.second,
+			std::string("ParseCount accepts \"") + eachCase.first + "\"");
+	}
+
+	const char* invalid[] = { "", "-1", "+1", " 5", "5 ", "5x", "M", "16MB", "0x10", "18446744073709551615k", "20000000000G" };
+
+	for (const char* eachText : invalid)
+	{
+		unsigned long long count = 0;
+		Check(!RunConfig::ParseCount(eachText, count), std::string("ParseCount rejects \"") + eachText + "\"");
+	}
+}
+
+/**
+	Checks a default configuration against roomy limits, then each limit that should 
+	reject it.
+*/
+void TestRunConfigValidate()
+{
+	const RunLimits roomy = { 1024, 1024, 256, (cl_ulong)1 << 30, (cl_ulong)4 << 30 };
+	RunConfig config;
+	config.numPixels = 1000000;
+	config.localSize = 64;
+	std::string error;
+
+	Check(config.Validate(roomy, 2, error), "Validate accepts a million pixels: " + error);
+
+	RunLimits limits = roomy;
+	limits.kernelWorkGroupSize = 32;
+	Check(!config.Validate(limits, 2, error) && error.find("Local size 64") == 0, "Validate rejects a local size above the kernel's");
+
+	limits = roomy;
+	limits.maxWorkItemSize = 16;
+	Check(!config.Validate(limits, 2, error), "Validate rejects a local size above the work-item limit");
+
+	/* A million pixels pad to 1000000 and take 16 MB, so 15 MB allocations are too small. */
+	limits = roomy;
+	limits.maxAllocation = (cl_ulong)15 << 20;
+	Check(!config.Validate(limits, 2, error) && error.find("largest allocation") != std::string::npos,
+		"Validate rejects a buffer above the largest allocation");
+
+	limits = roomy;
+	limits.globalMemory = (cl_ulong)24 << 20;
+	Check(config.Validate(limits, 1, error), "Validate accepts one buffer in 24 MB: " + error);
+	Check(!config.Validate(limits, 2, error) && error.find("global memory") != std::string::npos,
+		"Validate rejects two buffers in 24 MB");
+
+	config.numPixels = (size_t)UINT_MAX + 1;
+	Check(!config.Validate(roomy, 2, error) && error.find("index") != std::string::npos,
+		"Validate rejects more pixels than a cl_uint can index");
+}
+
+/**
+	Records a workload, then loads it with --replay and checks that the settings and 
+	operations come back.
+*/
+void TestWorkloadCaptureRoundTrip()
+{
+	std::string path = (std::filesystem::temp_directory_path() / "PixelTests.workload").string();
+
+	WorkloadCapture capture;
+	capture.Start(path);
+	capture.Set("pixels", "2M");
+	capture.Set("kernel", "scaleBrightness");
+	capture.Set("seed", "42");
+	capture.Set("local-size", "128");
+	Check(capture.AddOperation("serial"), "workload records an operation");
+	Check(capture.AddOperation("batched"), "workload records a second operation");
+	Check(capture.Save(), "workload saves");
+
+	std::string replayArgument = "--replay=" + path;
+	char* argv[] = { (char*)"PixelTests", (char*)replayArgument.c_str() };
+	int argc = 2;
+
+	RunConfig config;
+	std::string error;
+	if (Check(config.Load(argc, argv, error), "workload loads: " + error))
+	{
+		Check(config.numPixels == 2000000, "replayed pixel count");
+		Check(config.kernelName == "scaleBrightness", "replayed kernel");
+		Check(config.seed == 42, "replayed seed");
+		Check(config.localSize == 128, "replayed local size");
+
+		std::vector<std::string> operations =
+			WorkloadCapture::SplitList(CommandLine::GetOption(argc, argv, "--operations", nullptr));
+		Check(operations == std::vector<std::string>({ "serial", "batched" }), "replayed operations");
+	}
+
+	/* The command line replaces a recorded value. */
+	char* overrideArgv[] = { (char*)"PixelTests", (char*)replayArgument.c_str(), (char*)"--seed=7" };
+	if (Check(config.Load(3, overrideArgv, error), "workload loads with an override: " + error))
+	{
+		Check(config.seed == 7, "command line replaces the recorded seed");
+	}
+
+	std::remove(path.c_str());
+}
+
+/**
+	Checks that merging the statistics of two halves, or of an empty set, matches 
+	computing them over all the pixels at once.
+*/
+void TestColorStatisticsMerge()
+{
+	const size_t numPixels = 10007;
+	std::vector<cl_float4> pixels(numPixels);
+	for (size_t i = 0; i < numPixels; i++)
+	{
+		pixels[i] = Pixel::MakeRandomPixel(1234, i);
+	}
+
+	ColorStatistics whole = ColorStatistics::Compute(pixels.data(), numPixels);
+
+	for (size_t split : { (size_t)1, (size_t)4096, numPixels / 2, numPixels - 1 })
+	{
+		ColorStatistics merged = ColorStatistics::Compute(pixels.data(), split);
+		merged.Merge(ColorStatistics::Compute(pixels.data() + split, numPixels - split));
+
+		bool matches = merged.count == whole.count;
+		for (int i = 0; i < 4; i++)
+		{
+			matches = matches &&
+				IsClose(merged.mean[i], whole.mean[i], 1e-9) &&
+				IsClose(merged.m2[i], whole.m2[i], 1e-9) &&
+				merged.min[i] == whole.min[i] &&
+				merged.max[i] == whole.max[i];
+		}
+		Check(matches, "statistics merged at " + std::to_string(split) + " match the whole");
+	}
+
+	ColorStatistics empty;
+	ColorStatistics merged = whole;
+	merged.Merge(empty);
+	empty.Merge(whole);
+	Check(merged.count == whole.count && IsClose(merged.mean[0], whole.mean[0], 1e-12), "merging an empty set changes nothing");
+	Check(empty.count == whole.count && IsClose(empty.m2[3], whole.m2[3], 1e-12), "merging into an empty set copies");
+
+	ColorStatistics added;
+	for (const cl_float4& eachPixel : pixels)
+	{
+		added.Add(eachPixel);
+	}
+	Check(added.count == whole.count && IsClose(added.mean[1], whole.mean[1], 1e-9) && IsClose(added.m2[2], whole.m2[2], 1e-9),
+		"adding pixels one at a time matches the whole");
+}
+
+/**
+	Checks which byte ranges overlap, and that a command waits on earlier writes it 
+	reads or writes and on earlier reads it overwrites, but not on earlier reads it 
+	also only reads. The buffers are never dereferenced.
+*/
+void TestCommandGraphConflicts()
+{
+	cl_mem first = (cl_mem)(uintptr_t)0x1000;
+	cl_mem second = (cl_mem)(uintptr_t)0x2000;
+
+	Check(CommandGraph::Overlaps({ first, 0, 100 }, { first, 50, 100 }), "overlapping ranges overlap");
+	Check(!CommandGraph::Overlaps({ first, 0, 100 }, { first, 100, 100 }), "adjacent ranges do not overlap");
+	Check(!CommandGraph::Overlaps({ first, 0, 100 }, { second, 0, 100 }), "ranges of different buffers do not overlap");
+	Check(CommandGraph::Overlaps({ first, 10, 1 }, { first, 0, 100 }), "a contained range overlaps");
+	Check(!CommandGraph::Overlaps({ first, 0, 0 }, { first, 0, 100 }), "an empty range overlaps nothing");
+
+	CommandNode write = CommandNode();
+	write.writes = { { first, 0, 100 } };
+	CommandNode read = CommandNode();
+	read.reads = { { first, 0, 100 } };
+
+	Check(CommandGraph::Conflicts(write, { { first, 50, 10 } }, {}), "read after write waits");
+	Check(CommandGraph::Conflicts(write, {}, { { first, 99, 10 } }), "write after write waits");
+	Check(CommandGraph::Conflicts(read, {}, { { first, 0, 1 } }), "write after read waits");
+	Check(!CommandGraph::Conflicts(read, { { first, 0, 100 } }, {}), "read after read does not wait");
+	Check(!CommandGraph::Conflicts(write, { { first, 100, 10 } }, { { second, 0, 100 } }), "disjoint accesses do not wait");
+}
+
+/*========================================================================================
+	Main Function
+========================================================================================*/
+/**
+	Runs the test named by the first argument, or every test when none is given. 
+	Returns non-zero if any check failed or the name is unknown.
+*/
+int main(int argc, char* argv[])
+{
+	const std::pair<const char*, std::function<void()>> tests[] = {
+		{ "MetricHistogram", TestMetricHistogram },
+		{ "DeviceArenaSizeClass", TestDeviceArenaSizeClass },
+		{ "RunConfigParseCount", TestRunConfigParseCount },
+		{ "RunConfigValidate", TestRunConfigValidate },
+		{ "WorkloadCaptureRoundTrip", TestWorkloadCaptureRoundTrip },
+		{ "ColorStatisticsMerge", TestColorStatisticsMerge },
+		{ "CommandGraphConflicts", TestCommandGraphConflicts } };
+
+	std::string name = (argc > 1) ? argv[1] : "";
+	bool isFound = false;
+
+	for (const std::pair<const char*, std::function<void()>>& eachTest : tests)
+	{
+		if (name.empty() || name == eachTest.first)
+		{
+			isFound = true;
+			int failuresBefore = _failures;
+			eachTest.second();
+			std::cout << eachTest.first << ": " << (_failures == failuresBefore ? "passed" : "FAILED") << "\n";
+		}
+	}
+
+	if (!isFound)
+	{
+		std::cout << "Unknown test " << name << ".\n";
+		return 1;
+	}
+
+	return (_failures == 0) ? 0 : 1;
+}
+
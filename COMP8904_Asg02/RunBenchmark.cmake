@@ -0,0 +1,24 @@
+#=========================================================================================
+#	RunBenchmark
+#
+#	Runs one part for the benchmark target. Standard input is empty, so the parts'
+#	"press any key" pauses return at once, and a failed run fails the target.
+#
+#		cmake -DPART=<executable> -DARGS=<arguments> -P RunBenchmark.cmake
+#
+#=========================================================================================
+if(WIN32)
+	set(emptyInput NUL)
+else()
+	set(emptyInput /dev/null)
+endif()
+
+execute_process(
+	COMMAND ${PART} ${ARGS}
+	INPUT_FILE ${emptyInput}
+	RESULT_VARIABLE result
+)
+
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "${PART} failed (${result}).")
+endif()